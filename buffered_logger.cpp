@@ -1,34 +1,644 @@
 #include "buffered_logger.h"
+#include "log_hash.h"
+#include "log_compress.h"
+#include "log_pipeline.h"
 #include <iostream>
-#include <iomanip>
 #include <sstream>
 #include <cstdarg>
+#include <charconv>
+#include <ctime>
+#include <csignal>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 #include <algorithm>
 #include <cstring>
+#include <iterator>
+#include <limits>
+#include <cmath>
 
 namespace DisplayDriver {
 
-thread_local char BufferedLogger::s_formatBuffer[4096];
+namespace {
+
+constexpr size_t kCacheLineSize = 64;
+
+std::atomic<uint64_t> s_nextInstanceId{1};
+
+// Rendered blocks gathered into one sink write; bounds memory on huge flushes
+constexpr size_t kBlocksPerWrite = 16;
+
+// "00".."99": two digits per lookup for the fixed-width time fields
+constexpr char kDigitPairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+char* writeTwoDigits(char* out, unsigned value) {
+    std::memcpy(out, kDigitPairs + value * 2, 2);
+    return out + 2;
+}
+
+// Bytes an entry holds while buffered: its slot plus any out-of-line text
+size_t entryFootprint(const LogEntry& entry) {
+    return sizeof(LogEntry) + entry.message.overflowBytes();
+}
+
+// Full entry for a site record; the flush renders it like any other
+LogEntry expandRecord(const SiteRecord& record) {
+    LogEntry entry(record.level, std::string_view(record.args, record.argSize));
+    entry.threadId = record.threadId;
+    entry.siteId = record.siteId;
+    entry.category = record.category;
+    entry.ticks = record.ticks;
+    return entry;
+}
+
+// "Rate limit: suppressed N messages from file.cpp:line"
+std::string suppressedSummary(const LogSite& site, uint64_t suppressed) {
+    const char* file = std::strrchr(site.file(), '/');
+    return "Rate limit: suppressed " + std::to_string(suppressed) + " messages from " +
+           (file ? file + 1 : site.file()) + ":" + std::to_string(site.line());
+}
+
+size_t roundUpPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+// Fatal signals that run BufferedLogger::emergencyFlush (Config::emergencyFlushOnCrash)
+constexpr int kFatalSignals[] = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT};
+constexpr size_t kMaxCrashLoggers = 16;
+constexpr size_t kEmergencyBufferSize = 64 * 1024;
+constexpr size_t kEmergencyLineMax = 8 * 1024;  // Longer messages are cut
+constexpr size_t kCrashStackSize = 64 * 1024;
+
+std::atomic<BufferedLogger*> s_crashLoggers[kMaxCrashLoggers];
+struct sigaction s_previousActions[std::size(kFatalSignals)];
+std::atomic<pid_t> s_crashingThread{0};
+std::once_flag s_crashHandlerOnce;
+
+void fatalSignalHandler(int signal, siginfo_t*, void*) {
+    const int savedErrno = errno;
+    const pid_t self = static_cast<pid_t>(::syscall(SYS_gettid));
+    pid_t expected = 0;
+    if (s_crashingThread.compare_exchange_strong(expected, self)) {
+        for (auto& slot : s_crashLoggers) {
+            if (BufferedLogger* logger = slot.load(std::memory_order_acquire)) {
+                logger->emergencyFlush();
+            }
+        }
+    } else if (expected != self) {
+        // Another thread crashed first; it flushes and then ends the process
+        for (;;) {
+            ::pause();
+        }
+    }
+    
+    // Hand the signal to whatever was installed before, normally the default
+    // action: it is blocked until we return, then terminates as usual
+    for (size_t i = 0; i < std::size(kFatalSignals); i++) {
+        if (kFatalSignals[i] == signal) {
+            ::sigaction(signal, &s_previousActions[i], nullptr);
+        }
+    }
+    ::raise(signal);
+    errno = savedErrno;
+}
+
+void installCrashHandler() {
+    std::call_once(s_crashHandlerOnce, [] {
+        // A stack overflow leaves no room to run the handler; this thread
+        // (usually main) gets an alternate stack if it has none
+        stack_t current;
+        if (::sigaltstack(nullptr, &current) == 0 && (current.ss_flags & SS_DISABLE)) {
+            stack_t stack{};
+            stack.ss_sp = new char[kCrashStackSize];  // Kept for the life of the process
+            stack.ss_size = kCrashStackSize;
+            ::sigaltstack(&stack, nullptr);
+        }
+        
+        struct sigaction action{};
+        action.sa_sigaction = fatalSignalHandler;
+        action.sa_flags = SA_SIGINFO | SA_ONSTACK;
+        sigemptyset(&action.sa_mask);
+        for (size_t i = 0; i < std::size(kFatalSignals); i++) {
+            ::sigaction(kFatalSignals[i], &action, &s_previousActions[i]);
+        }
+    });
+}
+
+// Bounded wait for a lock a crashed producer may never release; the caller
+// reads the data regardless
+template <typename Mutex>
+bool tryLockBriefly(Mutex& mutex) {
+    for (int attempt = 0; attempt < 20; attempt++) {
+        if (mutex.try_lock()) {
+            return true;
+        }
+        struct timespec pause = {0, 1000000};
+        ::nanosleep(&pause, nullptr);
+    }
+    return false;
+}
+
+void writeFully(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t written = ::write(fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        data += written;
+        length -= static_cast<size_t>(written);
+    }
+}
+
+// The text format's line, built with arithmetic only: no allocation,
+// locale or time zone lookups. `localMs` is wall time plus the UTC offset.
+char* renderEmergencyLine(char* out, char* end, const LogEntry& entry, int64_t localMs) {
+    static const char* levelStrings[] = {
+        "TRACE", "DEBUG", "INFO ", "WARN ", "ERROR", "CRIT "
+    };
+    
+    int64_t second = localMs / 1000;
+    int64_t millis = localMs % 1000;
+    if (millis < 0) {
+        second--;
+        millis += 1000;
+    }
+    int64_t days = second / 86400;
+    int64_t secondOfDay = second % 86400;
+    if (secondOfDay < 0) {
+        days--;
+        secondOfDay += 86400;
+    }
+    
+    // Days since 1970-01-01 to a civil date (proleptic Gregorian)
+    days += 719468;
+    const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const unsigned dayOfEra = static_cast<unsigned>(days - era * 146097);
+    const unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    const unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    const unsigned monthIndex = (5 * dayOfYear + 2) / 153;
+    const unsigned day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+    const unsigned month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+    const unsigned year = static_cast<unsigned>(yearOfEra + era * 400 + (month <= 2)) % 10000;
+    
+    // The prefix takes under 64 bytes; callers pass at least kEmergencyLineMax
+    char* p = out;
+    *p++ = '[';
+    p = writeTwoDigits(p, year / 100);
+    p = writeTwoDigits(p, year % 100);
+    *p++ = '-';
+    p = writeTwoDigits(p, month);
+    *p++ = '-';
+    p = writeTwoDigits(p, day);
+    *p++ = ' ';
+    p = writeTwoDigits(p, static_cast<unsigned>(secondOfDay / 3600));
+    *p++ = ':';
+    p = writeTwoDigits(p, static_cast<unsigned>(secondOfDay / 60 % 60));
+    *p++ = ':';
+    p = writeTwoDigits(p, static_cast<unsigned>(secondOfDay % 60));
+    *p++ = '.';
+    *p++ = static_cast<char>('0' + millis / 100);
+    p = writeTwoDigits(p, static_cast<unsigned>(millis % 100));
+    std::memcpy(p, "] [", 3);
+    p += 3;
+    std::memcpy(p, levelStrings[static_cast<int>(entry.level)], 5);
+    p += 5;
+    std::memcpy(p, "] [T:", 5);
+    p += 5;
+    p = LogLineFormatter::writeThreadId(p, p + 24, entry.threadId);
+    *p++ = ']';
+    *p++ = ' ';
+    
+    // The message is cut first, so the repeat count and newline always fit
+    char* limit = end - 40;
+    auto append = [&](const char* text, size_t length) {
+        length = std::min(length, static_cast<size_t>(limit - p));
+        std::memcpy(p, text, length);
+        p += length;
+    };
+    if (entry.category) {
+        append("[", 1);
+        append(entry.category->name().data(), entry.category->name().size());
+        append("] ", 2);
+    }
+    // Deferred entries are rendered from their arguments like the flush
+    // would, without printf
+    const std::string_view payload(entry.message.data(), entry.message.size());
+    const LogSite* site = entry.siteId != 0 && !entry.format ? LogSiteRegistry::instance().tryFind(entry.siteId)
+                                                             : nullptr;
+    if (entry.formatter && entry.format) {
+        p = detail::renderDeferred(p, limit, entry.format, payload);
+    } else if (entry.formatter) {
+        // BufferedLogger::log entries carry their format as the first argument
+        uint32_t length = 0;
+        std::memcpy(&length, payload.data(), sizeof(length));
+        const size_t argsStart = std::min<size_t>(sizeof(length) + size_t{length} + 1, payload.size());
+        p = detail::renderDeferred(p, limit,
+                                   std::string_view(payload.data() + sizeof(length), argsStart - sizeof(length) - 1),
+                                   payload.substr(argsStart));
+    } else if (site) {
+        p = detail::renderDeferred(p, limit, site->format(), payload);
+    } else if (entry.siteId != 0 && !entry.format) {
+        // A thread registering a site holds the registry; print the id instead
+        char digits[16];
+        char* digitsEnd = std::to_chars(digits, digits + sizeof(digits), entry.siteId).ptr;
+        append("<site ", 6);
+        append(digits, static_cast<size_t>(digitsEnd - digits));
+        append("> [arguments not recorded]", 26);
+    } else {
+        append(entry.message.data(), entry.message.size());
+    }
+    limit = end - 1;
+    if (entry.count > 1) {
+        char digits[24];
+        char* digitsEnd = std::to_chars(digits, digits + sizeof(digits), entry.count).ptr;
+        append(" (repeated ", 11);
+        append(digits, static_cast<size_t>(digitsEnd - digits));
+        append(" times)", 7);
+    }
+    *p++ = '\n';
+    return p;
+}
+
+} // namespace
+
+// Single-producer/single-consumer ring owned by one producer thread.
+// The producer only writes m_tail, the consumer (flush path) only writes m_head;
+// each index lives on its own cache line to avoid false sharing.
+template <typename T>
+class alignas(kCacheLineSize) SpscRing {
+public:
+    explicit SpscRing(size_t capacity)
+        : m_slots(roundUpPowerOfTwo(std::max<size_t>(capacity, 2))),
+          m_mask(m_slots.size() - 1) {}
+    
+    bool tryPush(T&& entry) {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_cachedHead >= m_slots.size()) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail - m_cachedHead >= m_slots.size()) {
+                return false; // Full
+            }
+        }
+        
+        m_slots[tail & m_mask] = std::move(entry);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+    
+    size_t drainInto(std::vector<T>& out) {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        const size_t tail = m_tail.load(std::memory_order_acquire);
+        
+        for (size_t i = head; i != tail; ++i) {
+            out.push_back(std::move(m_slots[i & m_mask]));
+        }
+        
+        m_head.store(tail, std::memory_order_release);
+        return tail - head;
+    }
+    
+    // Visit pending entries without consuming them (emergency flush)
+    template <typename Visitor>
+    void peek(Visitor&& visit) const {
+        const size_t tail = m_tail.load(std::memory_order_acquire);
+        for (size_t i = m_head.load(std::memory_order_relaxed); i != tail; ++i) {
+            visit(m_slots[i & m_mask]);
+        }
+    }
+    
+    size_t sizeApprox() const {
+        return m_tail.load(std::memory_order_relaxed) - m_head.load(std::memory_order_relaxed);
+    }
+    
+    size_t capacity() const { return m_slots.size(); }
+
+private:
+    // Producer cache line
+    alignas(kCacheLineSize) std::atomic<size_t> m_tail{0};
+    size_t m_cachedHead = 0;
+    
+    // Consumer cache line
+    alignas(kCacheLineSize) std::atomic<size_t> m_head{0};
+    
+    alignas(kCacheLineSize) std::vector<T> m_slots;
+    const size_t m_mask;
+};
+
+// One producer thread's rings: full entries and compact site records
+class ThreadRing {
+public:
+    explicit ThreadRing(size_t capacity) : entries(capacity), records(capacity) {}
+    
+    SpscRing<LogEntry> entries;
+    SpscRing<SiteRecord> records;
+    
+    // Producer thread exited; the ring can be dropped once drained
+    void close() { m_closed.store(true, std::memory_order_release); }
+    bool closed() const { return m_closed.load(std::memory_order_acquire); }
+    
+    // Owning logger shut down; the producer should stop caching this ring
+    void detach() { m_detached.store(true, std::memory_order_relaxed); }
+    bool detached() const { return m_detached.load(std::memory_order_relaxed); }
+
+private:
+    alignas(kCacheLineSize) std::atomic<bool> m_closed{false};
+    std::atomic<bool> m_detached{false};
+};
+
+// Bounded multi-producer/single-consumer queue with per-slot sequence numbers.
+// A slot whose sequence equals the enqueue position is free for that producer;
+// sequence == position + 1 marks it ready for the consumer.
+template <typename T>
+class MpscQueue {
+public:
+    explicit MpscQueue(size_t capacity)
+        : m_slots(roundUpPowerOfTwo(std::max<size_t>(capacity, 2))),
+          m_mask(m_slots.size() - 1) {
+        for (size_t i = 0; i < m_slots.size(); ++i) {
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+    
+    bool tryPush(T&& entry) {
+        size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        Slot* slot;
+        
+        for (;;) {
+            slot = &m_slots[pos & m_mask];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            
+            if (diff == 0) {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // Full
+            } else {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        
+        slot->entry = std::move(entry);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+    
+    // Single consumer only
+    size_t drainInto(std::vector<T>& out) {
+        size_t drained = 0;
+        
+        for (;;) {
+            Slot& slot = m_slots[m_dequeuePos & m_mask];
+            if (slot.sequence.load(std::memory_order_acquire) != m_dequeuePos + 1) {
+                break; // Empty, or the next producer has not published yet
+            }
+            
+            out.push_back(std::move(slot.entry));
+            slot.sequence.store(m_dequeuePos + m_slots.size(), std::memory_order_release);
+            ++m_dequeuePos;
+            ++drained;
+        }
+        
+        return drained;
+    }
+    
+    // Visit published entries without consuming them (emergency flush)
+    template <typename Visitor>
+    void peek(Visitor&& visit) const {
+        for (size_t pos = m_dequeuePos;; ++pos) {
+            const Slot& slot = m_slots[pos & m_mask];
+            if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+                break;
+            }
+            visit(slot.entry);
+        }
+    }
+    
+    size_t capacity() const { return m_slots.size(); }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T entry;
+    };
+    
+    std::vector<Slot> m_slots;
+    const size_t m_mask;
+    alignas(kCacheLineSize) std::atomic<size_t> m_enqueuePos{0};
+    alignas(kCacheLineSize) size_t m_dequeuePos = 0;
+};
+
+// Lock-free open-addressing table of recently seen message hashes. Each
+// slot holds a key and the last time it was seen; a bounded probe window
+// keeps lookups O(1), and when it is full the stalest slot is recycled,
+// so the table tracks roughly the most recent `capacity` unique messages.
+// A slot is claimed with a CAS on its key and republished key-last, and
+// readers recheck the key after reading the time, so a time is only ever
+// matched against the key it was stored for. Races between threads logging
+// the same new message can at worst let an extra copy through, never
+// suppress a message outside its window.
+class DedupTable {
+public:
+    explicit DedupTable(size_t windowSize)
+        : m_slots(roundUpPowerOfTwo(std::max<size_t>(windowSize, 16) * 2)),
+          m_mask(m_slots.size() - 1) {}
+    
+    // Returns true if `key` was seen within `window` ticks (and refreshes it)
+    bool checkAndTouch(uint64_t key, int64_t now, int64_t window) {
+        if (key == kEmpty || key == kClaimed) {
+            key ^= 1; // Reserve both markers
+        }
+        
+        const size_t home = static_cast<size_t>(key * 0x9E3779B97F4A7C15ull >> 32) & m_mask;
+        Slot* stalest = nullptr;
+        uint64_t stalestKey = kEmpty;
+        int64_t stalestSeen = std::numeric_limits<int64_t>::max();
+        
+        for (size_t probe = 0; probe < kMaxProbe; ++probe) {
+            Slot& slot = m_slots[(home + probe) & m_mask];
+            uint64_t slotKey = slot.key.load(std::memory_order_acquire);
+            
+            if (slotKey == kEmpty) {
+                if (slot.key.compare_exchange_strong(slotKey, kClaimed, std::memory_order_acq_rel)) {
+                    publish(slot, key, now);
+                    return false;
+                }
+                // Lost the race for this slot; fall through and inspect the winner
+            }
+            if (slotKey == kClaimed) {
+                continue;  // Being republished by another thread
+            }
+            
+            int64_t lastSeen = slot.lastSeen.load(std::memory_order_acquire);
+            if (slot.key.load(std::memory_order_relaxed) != slotKey) {
+                continue;  // Recycled since the key was read; the time belongs to another key
+            }
+            
+            if (slotKey == key) {
+                if (now - lastSeen < window) {
+                    // Sliding window: a repeat extends it
+                    if (now > lastSeen) {
+                        slot.lastSeen.compare_exchange_strong(lastSeen, now, std::memory_order_acq_rel);
+                    }
+                    return true;
+                }
+                
+                // Expired: whoever restarts the window logs, everyone else deduplicates
+                return !slot.lastSeen.compare_exchange_strong(lastSeen, now, std::memory_order_acq_rel);
+            }
+            
+            if (lastSeen < stalestSeen) {
+                stalestSeen = lastSeen;
+                stalestKey = slotKey;
+                stalest = &slot;
+            }
+        }
+        
+        // Probe window full: recycle the least recently seen slot unless
+        // another thread got to it first (then this message is simply not tracked)
+        if (stalest && stalest->key.compare_exchange_strong(stalestKey, kClaimed, std::memory_order_acq_rel)) {
+            publish(*stalest, key, now);
+        }
+        return false;
+    }
+    
+    void clear() {
+        for (auto& slot : m_slots) {
+            slot.key.store(kEmpty, std::memory_order_relaxed);
+            slot.lastSeen.store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    static constexpr uint64_t kEmpty = 0;
+    static constexpr uint64_t kClaimed = ~uint64_t{0};
+    static constexpr size_t kMaxProbe = 8;
+    
+    struct Slot {
+        std::atomic<uint64_t> key{kEmpty};
+        std::atomic<int64_t> lastSeen{0};
+    };
+    
+    // The time is written before the key is released, so a reader that
+    // sees the new key also sees its time
+    static void publish(Slot& slot, uint64_t key, int64_t now) {
+        slot.lastSeen.store(now, std::memory_order_release);
+        slot.key.store(key, std::memory_order_release);
+    }
+    
+    std::vector<Slot> m_slots;
+    const size_t m_mask;
+};
+
+namespace {
+
+// Rings registered by the current thread, keyed by logger instance id.
+// Destroyed at thread exit, which marks each ring closed so the flush
+// worker drains what is left and then releases it.
+struct ThreadRingCache {
+    std::vector<std::pair<uint64_t, std::shared_ptr<ThreadRing>>> rings;
+    
+    ~ThreadRingCache() {
+        for (auto& ring : rings) {
+            ring.second->close();
+        }
+    }
+};
+
+thread_local ThreadRingCache t_ringCache;
+
+} // namespace
 
 BufferedLogger::BufferedLogger(const Config& config) 
     : m_config(config),
+      m_minimumLevel(config.minimumLevel),
+      m_clock(config.clockSource),
+      m_dedupWindowTicks(static_cast<int64_t>(m_clock.ticksFor(config.deduplicationTimeWindow))),
       m_primaryBuffer(),
-      m_secondaryBuffer() {
+      m_secondaryBuffer(),
+      m_maxPendingEntries(config.maxPendingEntries ? config.maxPendingEntries : 2 * config.bufferSize),
+      m_maxPendingBytes(config.maxPendingBytes ? config.maxPendingBytes : 2 * config.maxMemoryBytes),
+      m_instanceId(s_nextInstanceId.fetch_add(1, std::memory_order_relaxed)) {
     
     // Reserve buffer space
-    m_primaryBuffer.reserve(config.bufferSize);
-    m_secondaryBuffer.reserve(config.bufferSize);
+    m_primaryBuffer.entries.reserve(config.bufferSize);
+    m_secondaryBuffer.entries.reserve(config.bufferSize);
+    m_primaryBuffer.records.reserve(config.bufferSize);
+    m_secondaryBuffer.records.reserve(config.bufferSize);
     
-    // Initialize deduplication window
-    if (config.enableDeduplication) {
-        m_dedupeWindow.resize(config.deduplicationWindowSize, 0);
-    }
+    // Initialize deduplication table (kept even when disabled so it can be toggled at runtime)
+    m_dedupTable = std::make_unique<DedupTable>(config.deduplicationWindowSize);
+    m_dedupEnabled.store(config.enableDeduplication, std::memory_order_relaxed);
     
     // Open output file
     if (!config.outputFile.empty()) {
-        m_fileStream.open(config.outputFile, std::ios::out | std::ios::app);
-        if (!m_fileStream.is_open()) {
-            std::cerr << "Failed to open log file: " << config.outputFile << std::endl;
+        openFileSink();
+        if (config.rotation.maxBytes > 0 || config.rotation.maxAge.count() > 0) {
+            m_rotator = std::make_unique<LogRotator>(config.outputFile, config.rotation);
+        }
+    }
+    if (!config.flightRecorderFile.empty()) {
+        m_flightRecorder = std::make_unique<FlightRecorder>(config.flightRecorderFile, config.flightRecorderEntries,
+                                                            m_clock.source());
+        if (m_flightRecorder->isOpen()) {
+            m_flightRecorder->updateCalibration(m_clock);
+        } else {
+            m_flightRecorder.reset();
+        }
+    }
+    
+    m_pipeline = std::make_unique<LogPipeline>();
+    if (config.consoleOutput) {
+        SinkOptions console;
+        console.dedicatedThread = config.consoleThread;
+        m_pipeline->add(std::make_unique<StreamSink>(std::cout), console);
+    }
+    
+    if (config.queueType == QueueType::BoundedMpsc) {
+        m_mpscQueue = std::make_unique<MpscQueue<LogEntry>>(config.mpscQueueCapacity);
+        m_mpscRecords = std::make_unique<MpscQueue<SiteRecord>>(config.mpscQueueCapacity);
+    }
+    
+    if (config.emergencyFlushOnCrash) {
+        m_emergencyBuffer = std::make_unique<char[]>(kEmergencyBufferSize);
+        std::time_t now = std::time(nullptr);
+        std::tm local{};
+        localtime_r(&now, &local);
+        m_utcOffsetSeconds = local.tm_gmtoff;  // Fixed at startup: a DST change is not followed
+        
+        // Appending lines is only safe to a plain text file written with
+        // write(2); the other sinks keep their own offsets or framing
+        if (!config.outputFile.empty()) {
+            const bool plainText = config.fileSinkType == FileSinkType::Writev && !config.compressOutput &&
+                                   config.outputFormat == OutputFormat::Text;
+            m_emergencyPath = plainText ? config.outputFile : config.outputFile + ".crash";
+        }
+        
+        installCrashHandler();
+        bool registered = false;
+        for (auto& slot : s_crashLoggers) {
+            BufferedLogger* expected = nullptr;
+            if (slot.compare_exchange_strong(expected, this, std::memory_order_release)) {
+                registered = true;
+                break;
+            }
+        }
+        if (!registered) {
+            std::cerr << "Too many loggers with emergencyFlushOnCrash; this one is not flushed on a crash"
+                      << std::endl;
         }
     }
     
@@ -47,6 +657,12 @@ void BufferedLogger::shutdown() {
         return; // Already shut down
     }
     
+    // Past this point a crash has nothing to drain; the handler stays installed
+    for (auto& slot : s_crashLoggers) {
+        BufferedLogger* expected = this;
+        slot.compare_exchange_strong(expected, nullptr, std::memory_order_release);
+    }
+    
     // Signal shutdown
     {
         std::unique_lock<std::mutex> lock(m_flushMutex);
@@ -60,269 +676,1065 @@ void BufferedLogger::shutdown() {
     
     // Final flush
     forceFlush();
+    m_pipeline->stop();  // Sink threads deliver what they have queued
     
     // Close file
-    if (m_fileStream.is_open()) {
-        m_fileStream.close();
+    if (m_fileSink) {
+        m_fileSink->close();
+    }
+    m_rotator.reset();  // Finishes compressing rotated files
+    
+    // The final flush reported every count; free the counters for other loggers
+    {
+        std::lock_guard<std::mutex> lock(m_rateLimitsMutex);
+        for (auto& entry : m_rateLimits) {
+            entry.second.limit->releaseSuppressed(m_instanceId);
+        }
+    }
+    
+    // Let producer threads drop their cached rings
+    std::unique_lock<std::mutex> lock(m_ringsMutex);
+    for (auto& ring : m_rings) {
+        ring->detach();
     }
 }
 
-void BufferedLogger::log(LogLevel level, const std::string& message) {
-    if (level < m_config.minimumLevel) {
+void BufferedLogger::log(LogLevel level, std::string_view message) {
+    if (!isEnabled(level)) {
         return;
     }
     
-    uint32_t hash = 0;
-    if (m_config.enableDeduplication) {
-        hash = computeHash(message, level);
+    logText(nullptr, level, message);
+}
+
+void BufferedLogger::logText(const LogCategory* category, LogLevel level, std::string_view message) {
+    const uint64_t now = m_clock.now();  // One clock read serves dedup and the entry
+    uint64_t hash = 0;
+    if (m_dedupEnabled.load(std::memory_order_relaxed)) {
+        // Same text in different categories is not a repeat
+        hash = computeHash(message, level, reinterpret_cast<uintptr_t>(category));
         
-        auto now = std::chrono::steady_clock::now();
         if (shouldDeduplicate(hash, now)) {
             m_stats.totalDeduplicated.fetch_add(1, std::memory_order_relaxed);
             return;
         }
     }
     
-    LogEntry entry(level, message, hash);
-    internalLog(entry);
-}
-
-void BufferedLogger::log(LogLevel level, const char* format, ...) {
-    if (level < m_config.minimumLevel) {
-        return;
+    // Text is copied once, straight into its final storage
+    LogEntry entry(level, std::string_view(), hash);
+    entry.category = category;
+    entry.ticks = now;
+    if (internalLog(std::move(entry), message) && m_flightRecorder) {
+        m_flightRecorder->record(now, static_cast<int>(level), std::this_thread::get_id(),
+                                 category ? std::string_view(category->name()) : std::string_view(), message);
     }
-    
-    va_list args;
-    va_start(args, format);
-    vsnprintf(s_formatBuffer, sizeof(s_formatBuffer), format, args);
-    va_end(args);
-    
-    log(level, std::string(s_formatBuffer));
 }
 
-void BufferedLogger::internalLog(const LogEntry& entry) {
-    bool shouldFlush = false;
-    
-    {
-        std::unique_lock<std::mutex> lock(m_bufferMutex);
-        
-        auto& currentBuffer = m_useSecondaryBuffer ? m_secondaryBuffer : m_primaryBuffer;
-        currentBuffer.push_back(entry);
-        
-        m_stats.totalLogged.fetch_add(1, std::memory_order_relaxed);
-        m_stats.currentBufferSize.store(currentBuffer.size(), std::memory_order_relaxed);
+void BufferedLogger::logDeferred(const LogCategory* category, LogLevel level, const char* format,
+                                 DeferredFormatter formatter, LogMessage&& args) {
+    const uint64_t now = m_clock.now();
+    uint64_t hash = 0;
+    if (m_dedupEnabled.load(std::memory_order_relaxed)) {
+        // The arguments start with the format, so equal bytes render equal text
+        hash = computeHash(args, level, reinterpret_cast<uintptr_t>(category));
         
-        // Check if we need to flush
-        if (currentBuffer.size() >= m_config.bufferSize ||
-            estimateMemoryUsage() >= m_config.maxMemoryBytes) {
-            shouldFlush = true;
+        if (shouldDeduplicate(hash, now)) {
+            m_stats.totalDeduplicated.fetch_add(1, std::memory_order_relaxed);
+            return;
         }
     }
     
-    if (shouldFlush) {
-        if (m_config.asyncFlush) {
-            std::unique_lock<std::mutex> lock(m_flushMutex);
-            m_forceFlushRequested = true;
-            m_flushCv.notify_one();
-        } else {
-            performFlush();
-        }
+    // The recorder gets the arguments after the format; copied first, since
+    // the entry takes them. Longer ones never fit a slot either way.
+    char recordedArgs[FlightRecorder::kSlotSize];
+    size_t recordedSize = 0;
+    if (m_flightRecorder) {
+        const char* data = args.data();
+        detail::DeferredStringArg::read(data);
+        recordedSize = std::min(args.size() - static_cast<size_t>(data - args.data()), sizeof(recordedArgs));
+        std::memcpy(recordedArgs, data, recordedSize);
     }
-}
-
-void BufferedLogger::flush() {
-    if (m_config.asyncFlush) {
-        std::unique_lock<std::mutex> lock(m_flushMutex);
-        m_forceFlushRequested = true;
-        m_flushCv.notify_one();
-    } else {
-        performFlush();
+    
+    LogEntry entry(level, std::string_view(), hash);
+    entry.message = std::move(args);  // Format included; the entry's pointer stays null
+    entry.formatter = formatter;
+    entry.category = category;
+    entry.ticks = now;
+    if (internalLog(std::move(entry)) && m_flightRecorder) {
+        // Rendering stays on the flush thread; the ring keeps format and arguments
+        m_flightRecorder->record(now, static_cast<int>(level), std::this_thread::get_id(),
+                                 category ? std::string_view(category->name()) : std::string_view(),
+                                 format ? format : "(null)", true, std::string_view(recordedArgs, recordedSize));
     }
 }
 
-void BufferedLogger::forceFlush() {
-    performFlush();
-}
-
-void BufferedLogger::performFlush() {
-    std::vector<LogEntry> bufferToFlush;
-    
-    {
-        std::unique_lock<std::mutex> lock(m_bufferMutex);
+void BufferedLogger::logSiteRecord(const LogCategory* category, const LogSite& site, LogMessage&& args) {
+    // The site id already identifies level and format; only arguments vary
+    const uint64_t now = m_clock.now();
+    uint64_t hash = (site.id() * 0x9E3779B97F4A7C15ull) ^ reinterpret_cast<uintptr_t>(category);
+    if (m_dedupEnabled.load(std::memory_order_relaxed)) {
+        if (!args.empty()) {
+            hash = computeHash(args, site.level(), hash);
+        }
         
-        auto& currentBuffer = m_useSecondaryBuffer ? m_secondaryBuffer : m_primaryBuffer;
-        if (currentBuffer.empty()) {
+        if (shouldDeduplicate(hash, now)) {
+            m_stats.totalDeduplicated.fetch_add(1, std::memory_order_relaxed);
             return;
         }
-        
-        // Swap buffers for zero-copy flush
-        bufferToFlush.swap(currentBuffer);
-        m_useSecondaryBuffer = !m_useSecondaryBuffer;
-        
-        m_stats.currentBufferSize.store(0, std::memory_order_relaxed);
     }
     
-    // Write to file/console outside of lock
-    for (const auto& entry : bufferToFlush) {
-        std::string formatted = formatLogEntry(entry);
-        
-        if (m_fileStream.is_open()) {
-            m_fileStream << formatted << std::endl;
-        }
-        
-        if (m_config.consoleOutput) {
-            std::cout << formatted << std::endl;
-        }
+    char recordedArgs[FlightRecorder::kSlotSize];  // As in logDeferred
+    const size_t recordedSize = std::min(args.size(), sizeof(recordedArgs));
+    if (m_flightRecorder) {
+        std::memcpy(recordedArgs, args.data(), recordedSize);
     }
     
-    if (m_fileStream.is_open()) {
-        m_fileStream.flush();
+    bool admitted;
+    if (args.size() <= SiteRecord::kArgCapacity) {
+        SiteRecord record;
+        record.ticks = now;
+        record.category = category;
+        record.threadId = std::this_thread::get_id();
+        record.siteId = site.id();
+        record.level = site.level();
+        record.argSize = static_cast<uint32_t>(args.size());
+        std::memcpy(record.args, args.data(), args.size());
+        admitted = internalLog(std::move(record));
+    } else {
+        LogEntry entry(site.level(), std::string_view(), hash);
+        entry.message = std::move(args);
+        entry.siteId = site.id();
+        entry.category = category;
+        entry.ticks = now;
+        admitted = internalLog(std::move(entry));
     }
-    
-    // Call custom flush callback if set
-    if (m_flushCallback) {
-        m_flushCallback(bufferToFlush);
+    if (admitted && m_flightRecorder) {
+        m_flightRecorder->record(now, static_cast<int>(site.level()), std::this_thread::get_id(),
+                                 category ? std::string_view(category->name()) : std::string_view(), site.format(),
+                                 true, std::string_view(recordedArgs, recordedSize));
     }
-    
-    // Update stats
-    m_stats.totalFlushed.fetch_add(bufferToFlush.size(), std::memory_order_relaxed);
-    m_stats.totalFlushes.fetch_add(1, std::memory_order_relaxed);
-    m_stats.lastFlushTime = std::chrono::steady_clock::now();
-    
-    m_forceFlushRequested = false;
 }
 
-void BufferedLogger::flushWorker() {
-    while (!m_shutdown) {
-        std::unique_lock<std::mutex> lock(m_flushMutex);
-        
-        // Wait for flush interval or force flush request
-        m_flushCv.wait_for(lock, m_config.flushInterval, [this] {
-            return m_shutdown || m_forceFlushRequested;
-        });
-        
-        if (m_shutdown) {
-            break;
-        }
-        
-        lock.unlock();
-        performFlush();
+void BufferedLogger::reportSuppressed(const LogCategory* category, const LogSite& site, LogRateLimit& limit) {
+    const uint64_t suppressed = limit.takeSuppressed(m_instanceId);
+    if (suppressed == 0) {
+        return;  // Another thread reported them
     }
+    logText(category, site.level(), suppressedSummary(site, suppressed));
 }
 
-uint32_t BufferedLogger::computeHash(const std::string& message, LogLevel level) {
-    // FNV-1a hash for speed
-    uint32_t hash = 2166136261u;
-    
-    // Hash the log level
-    hash ^= static_cast<uint32_t>(level);
-    hash *= 16777619u;
-    
-    // Hash the message
-    for (char c : message) {
-        hash ^= static_cast<uint32_t>(c);
-        hash *= 16777619u;
+// First rejection here for a site: registers it for the flush reports and
+// counts the rejection in the limit's counter for this logger
+void BufferedLogger::trackRateLimit(const LogCategory* category, const LogSite& site, LogRateLimit& limit) {
+    std::lock_guard<std::mutex> lock(m_rateLimitsMutex);
+    // Keeps an existing entry
+    TrackedRateLimit& tracked =
+        m_rateLimits.emplace(site.id(), TrackedRateLimit{category, &site, &limit, 0}).first->second;
+    if (!limit.claimSuppressed(m_instanceId)) {
+        tracked.unslotted++;  // Reported by the next flush
     }
-    
-    return hash;
 }
 
-bool BufferedLogger::shouldDeduplicate(uint32_t hash, std::chrono::steady_clock::time_point now) {
-    std::unique_lock<std::mutex> lock(m_bufferMutex);
-    
-    auto it = m_dedupeMap.find(hash);
-    if (it != m_dedupeMap.end()) {
-        auto timeDiff = std::chrono::duration_cast<std::chrono::milliseconds>(
-            now - it->second.lastSeen);
-        
-        if (timeDiff < m_config.deduplicationTimeWindow) {
-            it->second.count++;
-            it->second.lastSeen = now;
-            return true; // Deduplicate
+// Summaries for the flush to append itself: logging them like any other
+// entry would run the overflow policy (and, with synchronous flushing, a
+// nested flush) from inside the flush that is to make room
+void BufferedLogger::takeRateLimitReports(std::vector<LogEntry>& out) {
+    std::lock_guard<std::mutex> lock(m_rateLimitsMutex);
+    for (auto& entry : m_rateLimits) {
+        TrackedRateLimit& tracked = entry.second;
+        if (!tracked.limit->hasSuppressed(m_instanceId) && tracked.unslotted == 0) {
+            continue;
         }
+        const uint64_t suppressed = tracked.limit->takeSuppressed(m_instanceId) + tracked.unslotted;
+        tracked.unslotted = 0;
+        if (suppressed == 0) {
+            continue;  // A producer reported them first
+        }
+        LogEntry report(tracked.site->level(), suppressedSummary(*tracked.site, suppressed));
+        report.category = tracked.category;
+        report.ticks = m_clock.now();
+        report.timestamp = m_clock.toSteady(report.ticks);
+        out.push_back(std::move(report));
+    }
+}
+
+// Returns false when the overflow policy dropped the entry, so callers only
+// mirror admitted entries into the flight recorder
+bool BufferedLogger::internalLog(LogEntry&& entry, std::string_view text) {
+    if (m_config.queueType != QueueType::SharedBuffer && !text.empty()) {
+        entry.message.assign(text);
+        text = std::string_view();
     }
     
-    // Add to deduplication tracking
-    m_dedupeMap[hash] = {now, 1};
+    // Shared-buffer text is copied into the arena only once admitted, but
+    // counts against the limit like text already stored
+    size_t bytes = entryFootprint(entry);
+    if (text.size() > LogMessage::kInlineCapacity) {
+        bytes += text.size();
+    }
+    bool stored = false;
+    if (m_config.overflowPolicy != OverflowPolicy::Grow && overLimit(bytes) &&
+        applyOverflowPolicy(entry, text, bytes, stored)) {
+        return stored;
+    }
     
-    // Maintain circular buffer of recent hashes
-    if (m_dedupeWindow[m_dedupeWindowIndex] != 0) {
-        // Remove old hash from map if it's only referenced here
-        auto oldHash = m_dedupeWindow[m_dedupeWindowIndex];
-        auto oldIt = m_dedupeMap.find(oldHash);
-        if (oldIt != m_dedupeMap.end()) {
-            auto age = std::chrono::duration_cast<std::chrono::milliseconds>(
-                now - oldIt->second.lastSeen);
-            if (age >= m_config.deduplicationTimeWindow) {
-                m_dedupeMap.erase(oldIt);
+    if (m_config.queueType == QueueType::PerThreadRing) {
+        ThreadRing* ring = acquireThreadRing();
+        const bool full = reserveQueued(bytes);
+        if (ring->entries.tryPush(std::move(entry))) {
+            m_stats.totalLogged.fetch_add(1, std::memory_order_relaxed);
+            if (full || ring->entries.sizeApprox() >= ring->entries.capacity() / 2) {
+                requestFlush();
+            }
+            return true;
+        }
+        releaseQueued(bytes);
+        // Ring full: fall through to the shared buffer rather than drop
+    } else if (m_mpscQueue) {
+        const bool full = reserveQueued(bytes);
+        if (m_mpscQueue->tryPush(std::move(entry))) {
+            m_stats.totalLogged.fetch_add(1, std::memory_order_relaxed);
+            if (full || m_stats.currentBufferSize.load(std::memory_order_relaxed) >= m_mpscQueue->capacity() / 2) {
+                requestFlush();
             }
+            return true;
         }
+        releaseQueued(bytes);
+        // Queue full: fall through to the shared buffer rather than drop
     }
     
-    m_dedupeWindow[m_dedupeWindowIndex] = hash;
-    m_dedupeWindowIndex = (m_dedupeWindowIndex + 1) % m_dedupeWindow.size();
+    enqueueShared(std::move(entry), text);
+    return true;
+}
+
+// Same frontends as entries, in queues of their own. Past an overflow limit
+// the record becomes an entry, so every policy applies to it unchanged.
+bool BufferedLogger::internalLog(SiteRecord&& record) {
+    const size_t bytes = sizeof(SiteRecord);
+    if (m_config.overflowPolicy != OverflowPolicy::Grow && overLimit(bytes)) {
+        return internalLog(expandRecord(record));
+    }
+    
+    if (m_config.queueType == QueueType::PerThreadRing) {
+        ThreadRing* ring = acquireThreadRing();
+        const bool full = reserveQueued(bytes);
+        if (ring->records.tryPush(std::move(record))) {
+            m_stats.totalLogged.fetch_add(1, std::memory_order_relaxed);
+            if (full || ring->records.sizeApprox() >= ring->records.capacity() / 2) {
+                requestFlush();
+            }
+            return true;
+        }
+        releaseQueued(bytes);
+    } else if (m_mpscRecords) {
+        const bool full = reserveQueued(bytes);
+        if (m_mpscRecords->tryPush(std::move(record))) {
+            m_stats.totalLogged.fetch_add(1, std::memory_order_relaxed);
+            if (full || m_stats.currentBufferSize.load(std::memory_order_relaxed) >= m_mpscRecords->capacity() / 2) {
+                requestFlush();
+            }
+            return true;
+        }
+        releaseQueued(bytes);
+    }
     
-    return false; // Don't deduplicate
+    enqueueShared(std::move(record));
+    return true;
 }
 
-std::string BufferedLogger::formatLogEntry(const LogEntry& entry) {
-    static const char* levelStrings[] = {
-        "TRACE", "DEBUG", "INFO ", "WARN ", "ERROR", "CRIT "
+// Adds an entry to the pending totals before it is pushed to a ring or
+// queue: a flush may drain it the moment the push lands and subtract it
+// right away, so counting afterwards would wrap the totals. True once they
+// call for a flush.
+bool BufferedLogger::reserveQueued(size_t bytes) {
+    size_t pending = m_stats.currentBufferSize.fetch_add(1, std::memory_order_relaxed) + 1;
+    size_t bufferedBytes = m_stats.currentBufferedBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    return pending >= m_config.bufferSize || bufferedBytes >= m_config.maxMemoryBytes;
+}
+
+// Takes back a reservation whose push failed
+void BufferedLogger::releaseQueued(size_t bytes) {
+    m_stats.currentBufferSize.fetch_sub(1, std::memory_order_relaxed);
+    m_stats.currentBufferedBytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+void BufferedLogger::enqueueShared(LogEntry&& entry, std::string_view text) {
+    bool shouldFlush = false;
+    
+    {
+        std::unique_lock<std::mutex> lock(m_bufferMutex);
+        
+        auto& currentBuffer = m_useSecondaryBuffer ? m_secondaryBuffer : m_primaryBuffer;
+        if (!text.empty()) {
+            entry.message.assign(text, currentBuffer.arena);
+        }
+        const size_t bytes = entryFootprint(entry);
+        currentBuffer.entries.push_back(std::move(entry));
+        
+        m_stats.totalLogged.fetch_add(1, std::memory_order_relaxed);
+        m_stats.currentBufferSize.fetch_add(1, std::memory_order_relaxed);
+        size_t bufferedBytes = m_stats.currentBufferedBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        
+        // Check if we need to flush
+        if (currentBuffer.entries.size() + currentBuffer.records.size() >= m_config.bufferSize ||
+            bufferedBytes >= m_config.maxMemoryBytes) {
+            shouldFlush = true;
+        }
+    }
+    
+    if (shouldFlush) {
+        requestFlush();
+    }
+}
+
+void BufferedLogger::enqueueShared(SiteRecord&& record) {
+    bool shouldFlush = false;
+    
+    {
+        std::unique_lock<std::mutex> lock(m_bufferMutex);
+        
+        auto& currentBuffer = m_useSecondaryBuffer ? m_secondaryBuffer : m_primaryBuffer;
+        currentBuffer.records.push_back(record);
+        
+        m_stats.totalLogged.fetch_add(1, std::memory_order_relaxed);
+        m_stats.currentBufferSize.fetch_add(1, std::memory_order_relaxed);
+        size_t bufferedBytes = m_stats.currentBufferedBytes.fetch_add(sizeof(SiteRecord), std::memory_order_relaxed) +
+                               sizeof(SiteRecord);
+        
+        if (currentBuffer.entries.size() + currentBuffer.records.size() >= m_config.bufferSize ||
+            bufferedBytes >= m_config.maxMemoryBytes) {
+            shouldFlush = true;
+        }
+    }
+    
+    if (shouldFlush) {
+        requestFlush();
+    }
+}
+
+// Counts across the shared buffer, rings and queue; concurrent producers
+// can each overshoot by one entry
+bool BufferedLogger::overLimit(size_t bytes) const {
+    return m_stats.currentBufferSize.load(std::memory_order_relaxed) >= m_maxPendingEntries ||
+           m_stats.currentBufferedBytes.load(std::memory_order_relaxed) + bytes > m_maxPendingBytes;
+}
+
+// Returns true when the policy consumed `entry`; `stored` tells whether it
+// was kept (DropOldest) rather than dropped
+bool BufferedLogger::applyOverflowPolicy(LogEntry& entry, std::string_view text, size_t bytes, bool& stored) {
+    requestFlush();
+    if (!m_config.asyncFlush && !overLimit(bytes)) {
+        return false;  // Flushed inline
+    }
+    
+    switch (m_config.overflowPolicy) {
+    case OverflowPolicy::Block: {
+        // The flush thread cannot wait for itself (a logging flush callback)
+        const bool flushThread = m_flushThread && std::this_thread::get_id() == m_flushThread->get_id();
+        if (!flushThread) {
+            std::unique_lock<std::mutex> lock(m_spaceMutex);
+            if (m_spaceCv.wait_for(lock, m_config.overflowBlockTimeout,
+                                   [&] { return m_shutdown || !overLimit(bytes); })) {
+                return false;
+            }
+        }
+        recordDrop(entry.level, DropReason::Timeout);
+        return true;
+    }
+    case OverflowPolicy::DropNewest:
+        recordDrop(entry.level, DropReason::Full);
+        return true;
+    case OverflowPolicy::DropOldest:
+        stored = evictOldest(std::move(entry), text);
+        return true;
+    case OverflowPolicy::DropBelowLevel:
+        if (entry.level >= m_config.overflowKeepLevel) {
+            return false;
+        }
+        recordDrop(entry.level, DropReason::BelowLevel);
+        return true;
+    case OverflowPolicy::Grow:
+        break;
+    }
+    return false;
+}
+
+// Returns false when there was nothing to evict and `entry` was dropped
+bool BufferedLogger::evictOldest(LogEntry&& entry, std::string_view text) {
+    std::unique_lock<std::mutex> lock(m_bufferMutex);
+    
+    auto& currentBuffer = m_useSecondaryBuffer ? m_secondaryBuffer : m_primaryBuffer;
+    if (currentBuffer.entries.empty()) {
+        // Everything pending is in the rings or queue, which only the flush path pops
+        lock.unlock();
+        recordDrop(entry.level, DropReason::Full);
+        return false;
+    }
+    
+    // Outside the arena, so the payload goes with the slot when it is overwritten again
+    if (!text.empty()) {
+        entry.message.assign(text);
+    }
+    if (currentBuffer.nextEviction >= currentBuffer.entries.size()) {
+        currentBuffer.nextEviction = 0;
+    }
+    LogEntry& oldest = currentBuffer.entries[currentBuffer.nextEviction++];
+    size_t freed = entryFootprint(oldest);
+    if (oldest.message.isBorrowed()) {
+        // The arena only frees its bytes on reset; they stay counted until the flush
+        freed -= oldest.message.overflowBytes();
+        currentBuffer.strandedBytes += oldest.message.overflowBytes();
+    }
+    const size_t added = entryFootprint(entry);
+    recordDrop(oldest.level, DropReason::Evicted);
+    oldest = std::move(entry);
+    currentBuffer.evicted = true;
+    
+    m_stats.totalLogged.fetch_add(1, std::memory_order_relaxed);
+    m_stats.currentBufferedBytes.fetch_add(added, std::memory_order_relaxed);
+    m_stats.currentBufferedBytes.fetch_sub(freed, std::memory_order_relaxed);
+    return true;
+}
+
+void BufferedLogger::recordDrop(LogLevel level, DropReason reason) {
+    m_stats.totalDropped.fetch_add(1, std::memory_order_relaxed);
+    m_stats.droppedByLevel[static_cast<size_t>(level)].fetch_add(1, std::memory_order_relaxed);
+    m_stats.droppedByReason[static_cast<size_t>(reason)].fetch_add(1, std::memory_order_relaxed);
+    m_droppedSinceReport.fetch_add(1, std::memory_order_relaxed);
+}
+
+void BufferedLogger::requestFlush() {
+    if (m_config.asyncFlush) {
+        // Only the first requester since the last flush pays for the wakeup
+        if (!m_forceFlushRequested.exchange(true)) {
+            std::unique_lock<std::mutex> lock(m_flushMutex);
+            m_flushCv.notify_one();
+        }
+    } else {
+        performFlush();
+    }
+}
+
+ThreadRing* BufferedLogger::acquireThreadRing() {
+    auto& cached = t_ringCache.rings;
+    for (auto& ring : cached) {
+        if (ring.first == m_instanceId) {
+            return ring.second.get();
+        }
+    }
+    
+    // First log from this thread: drop rings of loggers that have shut down
+    cached.erase(std::remove_if(cached.begin(), cached.end(),
+                                [](const auto& ring) { return ring.second->detached(); }),
+                 cached.end());
+    
+    auto ring = std::make_shared<ThreadRing>(m_config.threadRingCapacity);
+    {
+        std::unique_lock<std::mutex> lock(m_ringsMutex);
+        m_rings.push_back(ring);
+    }
+    cached.emplace_back(m_instanceId, ring);
+    return ring.get();
+}
+
+size_t BufferedLogger::drainThreadRings(std::vector<LogEntry>& out, std::vector<SiteRecord>& records) {
+    std::vector<std::shared_ptr<ThreadRing>> rings;
+    {
+        std::unique_lock<std::mutex> lock(m_ringsMutex);
+        rings = m_rings;
+    }
+    
+    size_t drained = 0;
+    bool anyClosed = false;
+    for (auto& ring : rings) {
+        // Check closed before draining so nothing pushed before exit is missed
+        bool closed = ring->closed();
+        drained += ring->entries.drainInto(out);
+        drained += ring->records.drainInto(records);
+        anyClosed |= closed;
+        if (closed) {
+            ring->detach();
+        }
+    }
+    
+    if (anyClosed) {
+        std::unique_lock<std::mutex> lock(m_ringsMutex);
+        m_rings.erase(std::remove_if(m_rings.begin(), m_rings.end(),
+                                     [](const auto& ring) { return ring->closed(); }),
+                      m_rings.end());
+    }
+    
+    return drained;
+}
+
+void BufferedLogger::flush() {
+    requestFlush();
+}
+
+void BufferedLogger::forceFlush() {
+    performFlush();
+}
+
+void BufferedLogger::emergencyFlush() noexcept {
+    if (!m_emergencyBuffer || m_emergencyFlushed.exchange(true)) {
+        return;
+    }
+    
+    int fd = STDERR_FILENO;
+    if (!m_emergencyPath.empty()) {
+        fd = ::open(m_emergencyPath.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            fd = STDERR_FILENO;
+        }
+    }
+    
+    // A producer that died mid-append holds these forever; after a short wait
+    // the containers are read unlocked, which at worst faults again and ends
+    // the process the way it was going anyway
+    const bool buffersLocked = tryLockBriefly(m_bufferMutex);
+    const bool ringsLocked = m_config.queueType == QueueType::PerThreadRing && tryLockBriefly(m_ringsMutex);
+    
+    char* const buffer = m_emergencyBuffer.get();
+    char* const bufferEnd = buffer + kEmergencyBufferSize;
+    char* p = buffer;
+    auto emit = [&](const LogEntry& entry) {
+        if (bufferEnd - p < static_cast<ptrdiff_t>(kEmergencyLineMax)) {
+            writeFully(fd, buffer, static_cast<size_t>(p - buffer));
+            p = buffer;
+        }
+        const int64_t wallMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+            m_clock.toWallClock(entry.ticks).time_since_epoch()).count();
+        p = renderEmergencyLine(p, p + kEmergencyLineMax, entry, wallMs + m_utcOffsetSeconds * 1000);
+    };
+    auto emitRecord = [&](const SiteRecord& record) {
+        // Arguments are kept only when they fit inline: the overflow would allocate
+        const size_t argSize = record.argSize <= LogMessage::kInlineCapacity ? record.argSize : 0;
+        LogEntry entry(record.level, std::string_view(record.args, argSize));
+        entry.threadId = record.threadId;
+        entry.siteId = record.siteId;
+        entry.category = record.category;
+        entry.ticks = record.ticks;
+        emit(entry);
     };
     
-    // Convert timestamp to time_t for formatting
-    auto timeT = std::chrono::system_clock::to_time_t(
-        std::chrono::system_clock::now() + 
-        (entry.timestamp - std::chrono::steady_clock::now()));
+    static const char kBanner[] = "*** emergency flush: entries pending at the crash follow ***\n";
+    writeFully(fd, kBanner, sizeof(kBanner) - 1);
     
-    std::stringstream ss;
-    ss << "[" << std::put_time(std::localtime(&timeT), "%Y-%m-%d %H:%M:%S");
+    // A flush in progress publishes the generation it retired once it stops
+    // moving entries around; what it has not written yet comes first, as
+    // the oldest. The entry it is rendering text for right now is skipped.
+    m_emergencyReading.store(true);
+    if (const LogEntry* flushing = m_flushProgress.entries.load()) {
+        const size_t count = m_flushProgress.count.load(std::memory_order_acquire);
+        const size_t resolved = m_flushProgress.resolved.load(std::memory_order_acquire);
+        for (size_t i = m_flushProgress.written.load(std::memory_order_acquire); i < count; i++) {
+            if (i != resolved) {
+                emit(flushing[i]);
+            }
+        }
+    }
     
-    // Add milliseconds
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        entry.timestamp.time_since_epoch()) % 1000;
-    ss << "." << std::setfill('0') << std::setw(3) << ms.count() << "] ";
+    LogBuffer& active = m_useSecondaryBuffer.load(std::memory_order_relaxed) ? m_secondaryBuffer
+                                                                             : m_primaryBuffer;
+    if (active.evicted && buffersLocked) {
+        // DropOldest overwrote slots round-robin; std::sort works in place
+        // (stable_sort would allocate)
+        std::sort(active.entries.begin(), active.entries.end(),
+                  [](const LogEntry& a, const LogEntry& b) { return a.ticks < b.ticks; });
+        active.nextEviction = 0;
+    }
+    for (const auto& entry : active.entries) {
+        emit(entry);
+    }
+    for (const auto& record : active.records) {
+        emitRecord(record);
+    }
+    if (m_config.queueType == QueueType::PerThreadRing) {
+        for (const auto& ring : m_rings) {
+            ring->entries.peek(emit);
+            ring->records.peek(emitRecord);
+        }
+    } else if (m_mpscQueue) {
+        m_mpscQueue->peek(emit);
+        m_mpscRecords->peek(emitRecord);
+    }
+    writeFully(fd, buffer, static_cast<size_t>(p - buffer));
+    m_emergencyReading.store(false);
     
-    // Add level
-    ss << "[" << levelStrings[static_cast<int>(entry.level)] << "] ";
+    if (ringsLocked) {
+        m_ringsMutex.unlock();
+    }
+    if (buffersLocked) {
+        m_bufferMutex.unlock();
+    }
+    if (fd != STDERR_FILENO) {
+        ::close(fd);
+    }
+}
+
+void BufferedLogger::performFlush() {
+    std::unique_lock<std::recursive_mutex> consumerLock(m_consumerMutex);
+    if (m_flushInProgress) {
+        return; // Re-entered from a flush callback; the outer flush owns the buffers
+    }
     
-    // Add thread ID
-    ss << "[T:" << std::hex << entry.threadId << std::dec << "] ";
+    // Cheap (a few clock reads), and keeps the tick rate and anchor fresh
+    m_clock.recalibrate();
+    m_dedupWindowTicks.store(static_cast<int64_t>(m_clock.ticksFor(m_config.deduplicationTimeWindow)),
+                             std::memory_order_relaxed);
+    const bool binary = m_config.outputFormat == OutputFormat::Binary;
+    if (binary) {
+        m_binaryEncoder.setCalibration(m_clock);
+    }
+    if (m_flightRecorder) {
+        m_flightRecorder->updateCalibration(m_clock);
+    }
     
-    // Add message
-    ss << entry.message;
+    LogBuffer* flushing;
+    {
+        std::unique_lock<std::mutex> lock(m_bufferMutex);
+        
+        // Retire the active generation; producers continue in the other one,
+        // which the previous flush left empty
+        flushing = m_useSecondaryBuffer ? &m_secondaryBuffer : &m_primaryBuffer;
+        m_useSecondaryBuffer = !m_useSecondaryBuffer;
+    }
     
-    // Add deduplication count if applicable
-    if (entry.count > 1) {
-        ss << " (repeated " << entry.count << " times)";
+    std::vector<LogEntry>& bufferToFlush = flushing->entries;
+    std::vector<SiteRecord>& records = flushing->records;
+    size_t sharedCount = bufferToFlush.size() + records.size();
+    size_t queuedCount = 0;
+    if (m_config.queueType == QueueType::PerThreadRing) {
+        queuedCount = drainThreadRings(bufferToFlush, records);
+    } else if (m_mpscQueue) {
+        queuedCount = m_mpscQueue->drainInto(bufferToFlush) + m_mpscRecords->drainInto(records);
+    }
+    
+    // Release the bytes as accounted on append, before expanding records
+    // and rendering change them
+    size_t flushedBytes = flushing->strandedBytes + records.size() * sizeof(SiteRecord);
+    for (const auto& entry : bufferToFlush) {
+        flushedBytes += entryFootprint(entry);
+    }
+    const bool mixed = !bufferToFlush.empty() && !records.empty();
+    for (const auto& record : records) {
+        bufferToFlush.push_back(expandRecord(record));
+    }
+    records.clear();
+    
+    // Rings only preserve per-thread order, queue-full fallbacks land in the
+    // shared buffer out of band, and records are queued apart from entries;
+    // restore global order in any of these cases
+    if ((m_config.queueType == QueueType::PerThreadRing && queuedCount > 0) ||
+        (sharedCount > 0 && queuedCount > 0) || mixed || flushing->evicted) {
+        std::stable_sort(bufferToFlush.begin(), bufferToFlush.end(),
+                         [](const LogEntry& a, const LogEntry& b) {
+                             return a.ticks < b.ticks;
+                         });
     }
     
-    return ss.str();
+    flushing->nextEviction = 0;
+    flushing->evicted = false;
+    flushing->strandedBytes = 0;
+    
+    const size_t dropped = m_droppedSinceReport.exchange(0, std::memory_order_relaxed);
+    takeRateLimitReports(m_rateLimitReports);  // Sites that went quiet since they were limited
+    if (bufferToFlush.empty() && dropped == 0 && m_rateLimitReports.empty()) {
+        return;
+    }
+    
+    m_flushInProgress = true;
+    
+    // Published for the emergency flush until written; the reserve keeps
+    // the reports appended below from moving the entries
+    bufferToFlush.reserve(bufferToFlush.size() + 1 + m_rateLimitReports.size());
+    m_flushProgress.written.store(0, std::memory_order_relaxed);
+    m_flushProgress.resolved.store(0, std::memory_order_relaxed);
+    m_flushProgress.count.store(bufferToFlush.size(), std::memory_order_relaxed);
+    m_flushProgress.entries.store(bufferToFlush.data());
+    
+    for (size_t i = 0; i < bufferToFlush.size(); i++) {
+        while (m_emergencyReading.load()) {
+            std::this_thread::yield();  // Entries from `resolved` on are being read as they are
+        }
+        bufferToFlush[i].timestamp = m_clock.toSteady(bufferToFlush[i].ticks);
+        resolveDeferred(bufferToFlush[i]);
+        m_flushProgress.resolved.store(i + 1, std::memory_order_release);
+    }
+    m_stats.currentBufferSize.fetch_sub(bufferToFlush.size(), std::memory_order_relaxed);
+    m_stats.currentBufferedBytes.fetch_sub(flushedBytes, std::memory_order_relaxed);
+    const size_t loggedCount = bufferToFlush.size();
+    if (m_config.overflowPolicy == OverflowPolicy::Block) {
+        std::lock_guard<std::mutex> lock(m_spaceMutex);
+        m_spaceCv.notify_all();
+    }
+    
+    // The limits have room again: say in the log itself what went missing
+    if (dropped > 0) {
+        const std::string text = "Overflow: " + std::to_string(dropped) + " messages dropped";
+        LogEntry report(LogLevel::WARNING, text);
+        report.ticks = m_clock.now();
+        report.timestamp = m_clock.toSteady(report.ticks);
+        bufferToFlush.push_back(std::move(report));
+    }
+    for (auto& report : m_rateLimitReports) {
+        bufferToFlush.push_back(std::move(report));
+    }
+    m_rateLimitReports.clear();
+    m_flushProgress.resolved.store(bufferToFlush.size(), std::memory_order_relaxed);
+    m_flushProgress.count.store(bufferToFlush.size(), std::memory_order_release);
+    
+    // Render into block-sized buffers and hand several blocks to the sink at
+    // once, so a flush costs a few writev calls instead of one per line
+    const size_t blockSize = std::max<size_t>(m_config.outputBlockSize, 1);
+    if (m_outputBlocks.size() < kBlocksPerWrite) {
+        m_outputBlocks.resize(kBlocksPerWrite);
+    }
+    size_t block = 0;
+    for (size_t i = 0; i < bufferToFlush.size(); i++) {
+        const LogEntry& entry = bufferToFlush[i];
+        if (!binary) {
+            m_lineFormatter.appendLine(m_outputBlocks[block], entry, m_clock.toWallClock(entry.ticks));
+        } else {
+            // Records only; text is rendered later by log_decode
+            m_binaryEncoder.appendEntry(m_outputBlocks[block], entry);
+        }
+        if (m_outputBlocks[block].size() >= blockSize && ++block == kBlocksPerWrite) {
+            writeOutputBlocks(block);
+            m_flushProgress.written.store(i + 1, std::memory_order_release);
+            block = 0;
+        }
+    }
+    writeOutputBlocks(block + 1);
+    
+    // An emergency flush that saw the entries reads them until it is done;
+    // the process is going down with it anyway
+    m_flushProgress.entries.store(nullptr);
+    while (m_emergencyReading.load()) {
+        std::this_thread::yield();
+    }
+    
+    if (m_fileSink) {
+        m_fileSink->flush();
+        publishSinkStats();
+    }
+    if (!m_pipeline->empty()) {
+        publishToSinks(bufferToFlush);
+    }
+    
+    // Call custom flush callback if set
+    if (m_flushCallback) {
+        m_flushCallback(bufferToFlush);
+    }
+    
+    // Update stats
+    m_stats.totalFlushed.fetch_add(loggedCount, std::memory_order_relaxed);
+    m_stats.totalFlushes.fetch_add(1, std::memory_order_relaxed);
+    m_stats.lastFlushTime = std::chrono::steady_clock::now();
+    
+    // Whole-generation reset: entries keep their capacity, payloads are rewound
+    bufferToFlush.clear();
+    flushing->arena.reset();
+    m_flushInProgress = false;
 }
 
-size_t BufferedLogger::estimateMemoryUsage() const {
-    size_t usage = 0;
+void BufferedLogger::writeOutputBlocks(size_t count) {
+    m_outputViews.clear();
+    for (size_t i = 0; i < count; i++) {
+        if (!m_outputBlocks[i].empty()) {
+            m_outputViews.emplace_back(m_outputBlocks[i]);
+        }
+    }
     
-    auto& currentBuffer = m_useSecondaryBuffer ? m_secondaryBuffer : m_primaryBuffer;
-    for (const auto& entry : currentBuffer) {
-        usage += sizeof(LogEntry) + entry.message.capacity();
+    if (!m_outputViews.empty()) {
+        size_t rendered = 0;
+        for (std::string_view view : m_outputViews) {
+            rendered += view.size();
+        }
+        m_stats.renderedBytes.fetch_add(rendered, std::memory_order_relaxed);
+        
+        if (m_fileSink) {
+            m_fileSink->write(m_outputViews.data(), m_outputViews.size());
+            
+            // Rotation happens here, between writes, so no producer ever waits on it
+            if (m_rotator && m_rotator->shouldRotate(m_fileStartBytes + m_fileSink->bytesAppended(), m_fileOpenedAt)) {
+                rotateFile();
+            }
+        }
+    }
+    
+    for (size_t i = 0; i < count; i++) {
+        m_outputBlocks[i].clear();
+    }
+}
+
+void BufferedLogger::publishToSinks(const std::vector<LogEntry>& entries) {
+    // Copied, because this generation's entries and arena are reused as soon
+    // as the flush ends; the batch lives until the slowest sink is done
+    auto batch = std::make_shared<LogBatch>();
+    const LogLevel level = m_pipeline->minimumLevel();
+    batch->entries.reserve(entries.size());
+    for (const auto& entry : entries) {
+        if (entry.level >= level) {
+            batch->entries.push_back(entry);
+        }
+    }
+    if (batch->entries.empty()) {
+        return;
+    }
+    batch->source = m_clock.source();
+    batch->ticksPerNs = m_clock.ticksPerNanosecond();
+    batch->anchor = m_clock.latestAnchor();
+    m_pipeline->publish(batch);
+}
+
+void BufferedLogger::openFileSink() {
+    FileSinkOptions options;
+    options.type = m_config.fileSinkType;
+    options.blockSize = m_config.outputBlockSize;
+    options.queueDepth = m_config.ioUringQueueDepth;
+    options.mapChunkSize = m_config.mmapChunkSize;
+    
+    struct stat st;
+    m_fileStartBytes = ::stat(m_config.outputFile.c_str(), &st) == 0 ? static_cast<uint64_t>(st.st_size) : 0;
+    m_fileOpenedAt = std::chrono::steady_clock::now();
+    m_fileSink = createFileSink(m_config.outputFile, options);
+    m_binaryEncoder.startFile();
+    if (m_config.compressOutput) {
+        m_fileSink = std::make_unique<CompressingSink>(std::move(m_fileSink));
     }
+}
+
+void BufferedLogger::rotateFile() {
+    // Close first: sinks that stage or preallocate finish the file here
+    m_fileSink->close();
+    m_retiredSyscalls += m_fileSink->syscallCount();
+    m_retiredBytes += m_fileSink->bytesAppended();
     
-    return usage;
+    if (m_rotator->rotate()) {
+        m_stats.totalRotations.fetch_add(1, std::memory_order_relaxed);
+    }
+    openFileSink();  // Reopens the same file if the rename failed
+}
+
+void BufferedLogger::publishSinkStats() {
+    m_stats.outputSyscalls.store(m_retiredSyscalls + m_fileSink->syscallCount(), std::memory_order_relaxed);
+    m_stats.outputBytes.store(m_retiredBytes + m_fileSink->bytesAppended(), std::memory_order_relaxed);
+}
+
+void BufferedLogger::flushWorker() {
+    while (!m_shutdown) {
+        std::unique_lock<std::mutex> lock(m_flushMutex);
+        
+        // Wait for flush interval or force flush request
+        m_flushCv.wait_for(lock, m_config.flushInterval, [this] {
+            return m_shutdown || m_forceFlushRequested;
+        });
+        
+        if (m_shutdown) {
+            break;
+        }
+        
+        m_forceFlushRequested = false;
+        lock.unlock();
+        performFlush();
+    }
+}
+
+uint64_t BufferedLogger::computeHash(std::string_view message, LogLevel level, uint64_t seed) {
+    // 64-bit keys keep collisions (i.e. wrongly suppressed messages) negligible;
+    // the level goes into the seed so equal text at different levels differs
+    return hash64(message, seed ^ (static_cast<uint64_t>(level) + 1) * 0xC2B2AE3D27D4EB4Full);
+}
+
+bool BufferedLogger::shouldDeduplicate(uint64_t hash, uint64_t nowTicks) {
+    return m_dedupTable->checkAndTouch(hash, static_cast<int64_t>(nowTicks),
+                                       m_dedupWindowTicks.load(std::memory_order_relaxed));
+}
+
+void BufferedLogger::resolveDeferred(LogEntry& entry) {
+    // Site records carry only the id until rendered; format is filled in here
+    if (entry.siteId != 0 && !entry.format) {
+        const LogSite* site = LogSiteRegistry::instance().find(entry.siteId);
+        if (site && site->formatter()) {
+            entry.format = site->format();
+            entry.formatter = site->formatter();
+        }
+    }
+    
+    if (entry.formatter) {
+        entry.message.assign(entry.formatter(entry.format, entry.message.data()));
+        entry.formatter = nullptr;
+    }
+}
+
+char* LogLineFormatter::writeThreadId(char* out, char* end, std::thread::id id) {
+    if constexpr (sizeof(std::thread::id) == sizeof(uint64_t)) {
+        uint64_t value;
+        std::memcpy(&value, &id, sizeof(value));
+        return std::to_chars(out, end, value, 16).ptr;
+    } else {
+        std::ostringstream ss;
+        ss << std::hex << id;
+        std::string text = ss.str();
+        size_t length = std::min(text.size(), static_cast<size_t>(end - out));
+        std::memcpy(out, text.data(), length);
+        return out + length;
+    }
+}
+
+void LogLineFormatter::appendLine(std::string& out, const LogEntry& entry,
+                                  std::chrono::system_clock::time_point wallTime) {
+    char threadId[32];
+    char* threadIdEnd = writeThreadId(threadId, threadId + sizeof(threadId), entry.threadId);
+    appendLine(out, entry.level, std::string_view(threadId, static_cast<size_t>(threadIdEnd - threadId)),
+               entry.category ? std::string_view(entry.category->name()) : std::string_view(),
+               std::string_view(entry.message.data(), entry.message.size()), entry.count, wallTime);
+}
+
+void LogLineFormatter::appendLine(std::string& out, LogLevel level, std::string_view threadId,
+                                  std::string_view category, std::string_view message, size_t count,
+                                  std::chrono::system_clock::time_point wallTime) {
+    static const char* levelStrings[] = {
+        "TRACE", "DEBUG", "INFO ", "WARN ", "ERROR", "CRIT "
+    };
+    
+    const int64_t wallMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        wallTime.time_since_epoch()).count();
+    int64_t second = wallMs / 1000;
+    int64_t millis = wallMs % 1000;
+    if (millis < 0) {
+        second--;
+        millis += 1000;
+    }
+    
+    // localtime_r (unlike localtime) is thread-safe, and only runs once per second
+    if (second != m_cachedSecond) {
+        std::time_t timeT = static_cast<std::time_t>(second);
+        std::tm local{};
+        localtime_r(&timeT, &local);
+        
+        char* p = m_cachedDate;
+        unsigned year = static_cast<unsigned>(local.tm_year + 1900) % 10000;
+        p = writeTwoDigits(p, year / 100);
+        p = writeTwoDigits(p, year % 100);
+        *p++ = '-';
+        p = writeTwoDigits(p, static_cast<unsigned>(local.tm_mon + 1));
+        *p++ = '-';
+        p = writeTwoDigits(p, static_cast<unsigned>(local.tm_mday));
+        *p++ = ' ';
+        p = writeTwoDigits(p, static_cast<unsigned>(local.tm_hour));
+        *p++ = ':';
+        p = writeTwoDigits(p, static_cast<unsigned>(local.tm_min));
+        *p++ = ':';
+        writeTwoDigits(p, static_cast<unsigned>(local.tm_sec));
+        m_cachedSecond = second;
+    }
+    
+    // Fixed-width prefix: "[" date ".mmm] [LEVEL] [T:" tid "] "
+    char prefix[64];
+    char* p = prefix;
+    *p++ = '[';
+    std::memcpy(p, m_cachedDate, sizeof(m_cachedDate));
+    p += sizeof(m_cachedDate);
+    *p++ = '.';
+    *p++ = static_cast<char>('0' + millis / 100);
+    p = writeTwoDigits(p, static_cast<unsigned>(millis % 100));
+    std::memcpy(p, "] [", 3);
+    p += 3;
+    std::memcpy(p, levelStrings[static_cast<int>(level)], 5);
+    p += 5;
+    std::memcpy(p, "] [T:", 5);
+    p += 5;
+    const size_t threadIdLength = std::min(threadId.size(), static_cast<size_t>(prefix + sizeof(prefix) - 2 - p));
+    std::memcpy(p, threadId.data(), threadIdLength);
+    p += threadIdLength;
+    *p++ = ']';
+    *p++ = ' ';
+    out.append(prefix, static_cast<size_t>(p - prefix));
+    
+    if (!category.empty()) {
+        out += '[';
+        out += category;
+        out += "] ";
+    }
+    
+    out += message;
+    
+    if (count > 1) {
+        char digits[24];
+        char* end = std::to_chars(digits, digits + sizeof(digits), count).ptr;
+        out += " (repeated ";
+        out.append(digits, static_cast<size_t>(end - digits));
+        out += " times)";
+    }
+    out += '\n';
 }
 
 void BufferedLogger::setMinimumLevel(LogLevel level) {
-    m_config.minimumLevel = level;
+    std::lock_guard<std::mutex> lock(m_categoriesMutex);
+    m_minimumLevel.store(level, std::memory_order_relaxed);
+    updateCategoryLevels();
+}
+
+LogCategory& BufferedLogger::category(std::string_view name) {
+    std::lock_guard<std::mutex> lock(m_categoriesMutex);
+    
+    // Walk "a.b.c" one prefix at a time, creating missing ancestors
+    LogCategory* parent = nullptr;
+    size_t dot = 0;
+    do {
+        dot = name.find('.', dot);
+        std::string_view prefix = name.substr(0, dot);
+        
+        auto it = std::find_if(m_categories.begin(), m_categories.end(),
+                               [prefix](const std::unique_ptr<LogCategory>& category) {
+                                   return category->name() == prefix;
+                               });
+        if (it != m_categories.end()) {
+            parent = it->get();
+        } else {
+            LogLevel inherited = parent ? parent->level() : m_minimumLevel.load(std::memory_order_relaxed);
+            m_categories.emplace_back(new LogCategory(*this, std::string(prefix), parent, inherited));
+            parent = m_categories.back().get();
+        }
+    } while (dot++ != std::string_view::npos);
+    return *parent;
+}
+
+void BufferedLogger::setCategoryLevel(std::string_view name, LogLevel level) {
+    category(name).setLevel(level);
+}
+
+void BufferedLogger::updateCategoryLevels() {
+    // Creation order puts parents first, so one pass resolves the hierarchy
+    const LogLevel root = m_minimumLevel.load(std::memory_order_relaxed);
+    for (auto& category : m_categories) {
+        int configured = category->m_configuredLevel.load(std::memory_order_relaxed);
+        LogLevel level = configured != LogCategory::kInherit ? static_cast<LogLevel>(configured)
+                       : category->m_parent ? category->m_parent->level()
+                       : root;
+        category->m_effectiveLevel.store(level, std::memory_order_relaxed);
+    }
+}
+
+void LogCategory::setLevel(LogLevel level) {
+    std::lock_guard<std::mutex> lock(m_owner.m_categoriesMutex);
+    m_configuredLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+    m_owner.updateCategoryLevels();
+}
+
+void LogCategory::clearLevel() {
+    std::lock_guard<std::mutex> lock(m_owner.m_categoriesMutex);
+    m_configuredLevel.store(kInherit, std::memory_order_relaxed);
+    m_owner.updateCategoryLevels();
 }
 
 void BufferedLogger::enableDeduplication(bool enable) {
-    std::unique_lock<std::mutex> lock(m_bufferMutex);
-    m_config.enableDeduplication = enable;
+    m_dedupEnabled.store(enable, std::memory_order_relaxed);
     
     if (!enable) {
-        m_dedupeMap.clear();
-        std::fill(m_dedupeWindow.begin(), m_dedupeWindow.end(), 0);
-        m_dedupeWindowIndex = 0;
+        m_dedupTable->clear();
     }
 }
 
@@ -330,4 +1742,621 @@ void BufferedLogger::setFlushCallback(std::function<void(const std::vector<LogEn
     m_flushCallback = callback;
 }
 
+char* PayloadArena::allocate(size_t size) {
+    while (m_currentBlock < m_blocks.size()) {
+        Block& block = m_blocks[m_currentBlock];
+        if (block.size - m_offset >= size) {
+            char* out = block.data.get() + m_offset;
+            m_offset += size;
+            m_bytesUsed += size;
+            return out;
+        }
+        m_currentBlock++;
+        m_offset = 0;
+    }
+    
+    size_t blockSize = std::max(size, kBlockSize);
+    m_blocks.push_back({std::make_unique<char[]>(blockSize), blockSize});
+    m_bytesReserved += blockSize;
+    m_currentBlock = m_blocks.size() - 1;
+    m_offset = size;
+    m_bytesUsed += size;
+    return m_blocks.back().data.get();
+}
+
+void PayloadArena::reset() {
+    // Oversized blocks come from rare huge messages; don't keep them around
+    auto oversized = std::remove_if(m_blocks.begin(), m_blocks.end(),
+                                    [](const Block& block) { return block.size > kBlockSize; });
+    for (auto it = oversized; it != m_blocks.end(); ++it) {
+        m_bytesReserved -= it->size;
+    }
+    m_blocks.erase(oversized, m_blocks.end());
+    
+    m_currentBlock = 0;
+    m_offset = 0;
+    m_bytesUsed = 0;
+}
+
+struct MessageArena::Chunk {
+    std::atomic<uint32_t> refs;
+    size_t capacity;
+    size_t used;
+    
+    char* data() { return reinterpret_cast<char*>(this + 1); }
+};
+
+namespace {
+
+MessageArena::Chunk* newArenaChunk(size_t capacity) {
+    void* memory = ::operator new(sizeof(MessageArena::Chunk) + capacity);
+    auto* chunk = static_cast<MessageArena::Chunk*>(memory);
+    chunk->refs.store(1, std::memory_order_relaxed);
+    chunk->capacity = capacity;
+    chunk->used = 0;
+    return chunk;
+}
+
+// The calling thread's current chunk; the cache holds one reference to it
+struct ArenaChunkCache {
+    MessageArena::Chunk* current = nullptr;
+    
+    ~ArenaChunkCache() {
+        if (current) {
+            MessageArena::release(current);
+        }
+    }
+};
+
+thread_local ArenaChunkCache t_arenaChunk;
+
+} // namespace
+
+char* MessageArena::allocate(size_t size, Chunk*& chunk) {
+    // Oversized requests get a dedicated chunk rather than wasting the current one
+    if (size > kChunkSize / 4) {
+        chunk = newArenaChunk(size);
+        chunk->used = size;
+        return chunk->data();
+    }
+    
+    Chunk*& current = t_arenaChunk.current;
+    if (!current || current->capacity - current->used < size) {
+        if (current) {
+            release(current);
+        }
+        current = newArenaChunk(kChunkSize);
+    }
+    
+    char* out = current->data() + current->used;
+    current->used += size;
+    retain(current);
+    chunk = current;
+    return out;
+}
+
+void MessageArena::retain(Chunk* chunk) {
+    chunk->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void MessageArena::release(Chunk* chunk) {
+    if (chunk->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        ::operator delete(chunk);
+    }
+}
+
+LogSite::LogSite(LogLevel level, const char* file, int line, const char* format)
+    : m_id(0),
+      m_level(level),
+      m_file(file),
+      m_line(line),
+      m_format(format) {
+    m_id = LogSiteRegistry::instance().add(this);
+}
+
+LogSiteRegistry& LogSiteRegistry::instance() {
+    static LogSiteRegistry registry;
+    return registry;
+}
+
+uint32_t LogSiteRegistry::add(LogSite* site) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_sites.push_back(site);
+    return static_cast<uint32_t>(m_sites.size());
+}
+
+const LogSite* LogSiteRegistry::find(uint32_t id) const {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (id == 0 || id > m_sites.size()) {
+        return nullptr;
+    }
+    return m_sites[id - 1];
+}
+
+const LogSite* LogSiteRegistry::tryFind(uint32_t id) const {
+    std::unique_lock<std::mutex> lock(m_mutex, std::try_to_lock);
+    if (!lock.owns_lock() || id == 0 || id > m_sites.size()) {
+        return nullptr;
+    }
+    return m_sites[id - 1];
+}
+
+size_t LogSiteRegistry::size() const {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return m_sites.size();
+}
+
+size_t LogSiteRegistry::setEnabled(const char* file, int line, bool enabled) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    
+    const size_t fileLength = std::strlen(file);
+    size_t matched = 0;
+    for (LogSite* site : m_sites) {
+        const size_t siteLength = std::strlen(site->file());
+        bool fileMatches = siteLength >= fileLength &&
+                           std::strcmp(site->file() + siteLength - fileLength, file) == 0;
+        
+        if (fileMatches && (line == 0 || site->line() == line)) {
+            site->setEnabled(enabled);
+            matched++;
+        }
+    }
+    
+    return matched;
+}
+
+namespace detail {
+
+std::string formatPrintf(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    
+    va_list sizingArgs;
+    va_copy(sizingArgs, args);
+    int length = vsnprintf(nullptr, 0, format, sizingArgs);
+    va_end(sizingArgs);
+    
+    std::string result;
+    if (length > 0) {
+        result.resize(static_cast<size_t>(length));
+        vsnprintf(&result[0], result.size() + 1, format, args);
+    }
+    
+    va_end(args);
+    return result;
+}
+
+namespace {
+
+// One printf conversion's output into [out, end): `prefix` (sign, 0x) and
+// `body` padded to `width`, with zeros between them when `zeroPad`
+char* putField(char* out, char* end, std::string_view prefix, std::string_view body, int width, bool left,
+               bool zeroPad) {
+    auto put = [&](const char* text, size_t length) {
+        length = std::min(length, static_cast<size_t>(end - out));
+        std::memcpy(out, text, length);
+        out += length;
+    };
+    auto fill = [&](char c, size_t count) {
+        count = std::min(count, static_cast<size_t>(end - out));
+        std::memset(out, c, count);
+        out += count;
+    };
+    const size_t length = prefix.size() + body.size();
+    const size_t padding = width > 0 && static_cast<size_t>(width) > length ? width - length : 0;
+    if (!left && !zeroPad) {
+        fill(' ', padding);
+    }
+    put(prefix.data(), prefix.size());
+    if (!left && zeroPad) {
+        fill('0', padding);
+    }
+    put(body.data(), body.size());
+    if (left) {
+        fill(' ', padding);
+    }
+    return out;
+}
+
+// Digits of `value` in `base`, at least `minDigits` of them, ending at `end`
+char* writeDigitsBackward(char* end, uint64_t value, unsigned base, bool upper, int minDigits) {
+    const char* digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    char* p = end;
+    while (value != 0) {
+        *--p = digits[value % base];
+        value /= base;
+    }
+    while (end - p < minDigits) {
+        *--p = '0';
+    }
+    return p;
+}
+
+constexpr uint64_t kPowersOfTen[] = {
+    1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull,
+    1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull,
+    100000000000000ull, 1000000000000000ull, 10000000000000000ull, 100000000000000000ull};
+constexpr int kMaxFloatDigits = 17;
+
+// Nearest integer, ties to even like printf's rounding of exact halves
+uint64_t roundHalfEven(double value) {
+    uint64_t integer = static_cast<uint64_t>(value);
+    const double remainder = value - static_cast<double>(integer);
+    if (remainder > 0.5 || (remainder == 0.5 && (integer & 1))) {
+        integer++;
+    }
+    return integer;
+}
+
+// Decimal exponent and the first `digits` significant digits of `value`
+// (> 0, finite), rounded
+void splitDecimal(double value, int digits, uint64_t& mantissa, int& exponent) {
+    exponent = 0;
+    while (value >= 1e16) {
+        value /= 1e16;
+        exponent += 16;
+    }
+    while (value >= 10) {
+        value /= 10;
+        exponent++;
+    }
+    while (value < 1e-16) {
+        value *= 1e16;
+        exponent -= 16;
+    }
+    while (value < 1) {
+        value *= 10;
+        exponent--;
+    }
+    mantissa = roundHalfEven(value * static_cast<double>(kPowersOfTen[digits - 1]));
+    if (mantissa >= kPowersOfTen[digits]) {
+        mantissa /= 10;
+        exponent++;
+    }
+}
+
+// %f / %e / %g body for a finite, non-negative value
+size_t formatFloat(char* buffer, size_t capacity, double value, char conversion, int precision, bool alt) {
+    const bool upper = conversion == 'E' || conversion == 'G';
+    char lowered = static_cast<char>(conversion | 0x20);
+    if (lowered == 'a') {
+        lowered = 'e';
+    }
+    if (precision < 0) {
+        precision = 6;
+    }
+    
+    int exponent = 0;
+    uint64_t mantissa = 0;
+    bool stripZeros = false;
+    if (lowered == 'g') {
+        const int significant = std::min(std::max(precision, 1), kMaxFloatDigits);
+        if (value != 0) {
+            splitDecimal(value, significant, mantissa, exponent);
+        }
+        if (exponent < -4 || exponent >= significant) {
+            lowered = 'e';
+            precision = significant - 1;
+        } else {
+            lowered = 'f';
+            precision = significant - 1 - exponent;
+        }
+        stripZeros = !alt;
+    }
+    
+    char* end = buffer + capacity;
+    char* p = buffer;
+    auto putDigits = [&](uint64_t digits, int count) {
+        char scratch[24];
+        char* first = writeDigitsBackward(scratch + sizeof(scratch), digits, 10, false, count);
+        size_t length = std::min(static_cast<size_t>(scratch + sizeof(scratch) - first),
+                                 static_cast<size_t>(end - p));
+        std::memcpy(p, first, length);
+        p += length;
+    };
+    
+    const int fractionDigits = std::min(precision, kMaxFloatDigits - 1);
+    if (lowered == 'f' && value >= 1e17) {
+        lowered = 'e';  // The integer part would not fit
+    }
+    if (lowered == 'f') {
+        // Integer part and the fraction scaled to integers; precision past
+        // what a double holds prints as zeros
+        uint64_t integer = static_cast<uint64_t>(value);
+        double fraction = (value - static_cast<double>(integer)) * static_cast<double>(kPowersOfTen[fractionDigits]);
+        uint64_t scaled = roundHalfEven(fraction);
+        if (scaled >= kPowersOfTen[fractionDigits]) {
+            scaled -= kPowersOfTen[fractionDigits];
+            integer++;
+        }
+        putDigits(integer, 1);
+        if (precision > 0 || alt) {
+            *p++ = '.';
+        }
+        if (fractionDigits > 0) {
+            putDigits(scaled, fractionDigits);
+        }
+        for (int i = fractionDigits; i < precision && p < end; i++) {
+            *p++ = '0';
+        }
+    } else {
+        const int digits = std::min(fractionDigits, kMaxFloatDigits - 1) + 1;
+        if (value != 0) {
+            splitDecimal(value, digits, mantissa, exponent);
+        } else {
+            mantissa = 0;
+            exponent = 0;
+        }
+        const uint64_t scale = kPowersOfTen[digits - 1];
+        putDigits(mantissa / scale, 1);
+        if (precision > 0 || alt) {
+            *p++ = '.';
+        }
+        if (digits > 1) {
+            putDigits(mantissa % scale, digits - 1);
+        }
+        for (int i = digits - 1; i < precision && p < end - 5; i++) {
+            *p++ = '0';
+        }
+        if (lowered == 'e') {
+            *p++ = upper ? 'E' : 'e';
+            *p++ = exponent < 0 ? '-' : '+';
+            putDigits(static_cast<uint64_t>(exponent < 0 ? -exponent : exponent), 2);
+        }
+    }
+    
+    if (stripZeros) {
+        // %g drops trailing zeros of the fraction, and the point with them
+        char* suffix = std::find(buffer, p, upper ? 'E' : 'e');
+        if (std::find(buffer, suffix, '.') != suffix) {
+            char* q = suffix;
+            while (q[-1] == '0') {
+                q--;
+            }
+            if (q[-1] == '.') {
+                q--;
+            }
+            const size_t suffixLength = static_cast<size_t>(p - suffix);
+            std::memmove(q, suffix, suffixLength);
+            p = q + suffixLength;
+        }
+    }
+    return static_cast<size_t>(p - buffer);
+}
+
+} // namespace
+
+char* renderDeferred(char* out, char* end, std::string_view format, std::string_view args) {
+    size_t next = 0;
+    auto read = [&](void* value, size_t size) {
+        if (args.size() - next < size) {
+            return false;
+        }
+        std::memcpy(value, args.data() + next, size);
+        next += size;
+        return true;
+    };
+    auto put = [&](const char* text, size_t length) {
+        length = std::min(length, static_cast<size_t>(end - out));
+        std::memcpy(out, text, length);
+        out += length;
+    };
+    auto isDigit = [](char c) { return c >= '0' && c <= '9'; };
+    
+    size_t i = 0;
+    while (i < format.size()) {
+        if (format[i] != '%') {
+            const size_t literal = std::min(format.find('%', i), format.size());
+            put(format.data() + i, literal - i);
+            i = literal;
+            continue;
+        }
+        const size_t start = i++;
+        if (i < format.size() && format[i] == '%') {
+            put("%", 1);
+            i++;
+            continue;
+        }
+        
+        bool left = false, zeroPad = false, plus = false, space = false, alt = false;
+        for (; i < format.size(); i++) {
+            const char c = format[i];
+            if (c == '-') {
+                left = true;
+            } else if (c == '0') {
+                zeroPad = true;
+            } else if (c == '+') {
+                plus = true;
+            } else if (c == ' ') {
+                space = true;
+            } else if (c == '#') {
+                alt = true;
+            } else {
+                break;
+            }
+        }
+        bool ok = true;
+        int width = 0;
+        int precision = -1;
+        if (i < format.size() && format[i] == '*') {
+            ok = read(&width, sizeof(width));
+            if (width < 0) {
+                left = true;
+                width = -width;
+            }
+            i++;
+        }
+        for (; i < format.size() && isDigit(format[i]); i++) {
+            width = std::min(width * 10 + (format[i] - '0'), 4096);
+        }
+        if (i < format.size() && format[i] == '.') {
+            precision = 0;
+            i++;
+            if (i < format.size() && format[i] == '*') {
+                ok = ok && read(&precision, sizeof(precision));
+                i++;
+            }
+            for (; i < format.size() && isDigit(format[i]); i++) {
+                precision = std::min(precision * 10 + (format[i] - '0'), 4096);
+            }
+        }
+        size_t integerSize = sizeof(int);
+        bool longDouble = false;
+        if (i < format.size()) {
+            switch (format[i]) {
+            case 'h':
+                i += i + 1 < format.size() && format[i + 1] == 'h' ? 2 : 1;
+                break;
+            case 'l':
+                if (i + 1 < format.size() && format[i + 1] == 'l') {
+                    integerSize = sizeof(long long);
+                    i += 2;
+                } else {
+                    integerSize = sizeof(long);
+                    i++;
+                }
+                break;
+            case 'z':
+                integerSize = sizeof(size_t);
+                i++;
+                break;
+            case 'j':
+                integerSize = sizeof(intmax_t);
+                i++;
+                break;
+            case 't':
+                integerSize = sizeof(ptrdiff_t);
+                i++;
+                break;
+            case 'L':
+                longDouble = true;
+                i++;
+                break;
+            }
+        }
+        const char conversion = i < format.size() ? format[i++] : '\0';
+        
+        char buffer[64];
+        char* bufferEnd = buffer + sizeof(buffer);
+        std::string_view prefix;
+        std::string_view body;
+        bool numeric = true;  // Takes zero padding
+        bool floating = false;
+        switch (conversion) {
+        case 'd':
+        case 'i': {
+            int64_t value = 0;
+            if (integerSize == sizeof(int)) {
+                int narrow = 0;
+                ok = ok && read(&narrow, sizeof(narrow));
+                value = narrow;
+            } else {
+                ok = ok && read(&value, sizeof(value));
+            }
+            const uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+            char* first = writeDigitsBackward(bufferEnd, magnitude, 10, false, precision < 0 ? 1 : precision);
+            body = std::string_view(first, static_cast<size_t>(bufferEnd - first));
+            prefix = value < 0 ? "-" : plus ? "+" : space ? " " : "";
+            break;
+        }
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X': {
+            uint64_t value = 0;
+            if (integerSize == sizeof(int)) {
+                unsigned narrow = 0;
+                ok = ok && read(&narrow, sizeof(narrow));
+                value = narrow;
+            } else {
+                ok = ok && read(&value, sizeof(value));
+            }
+            const unsigned base = conversion == 'u' ? 10 : conversion == 'o' ? 8 : 16;
+            char* first = writeDigitsBackward(bufferEnd, value, base, conversion == 'X', precision < 0 ? 1 : precision);
+            if (alt && conversion == 'o' && *first != '0') {
+                *--first = '0';
+            }
+            body = std::string_view(first, static_cast<size_t>(bufferEnd - first));
+            if (alt && base == 16 && value != 0) {
+                prefix = conversion == 'X' ? "0X" : "0x";
+            }
+            break;
+        }
+        case 'c': {
+            int value = 0;
+            ok = ok && read(&value, sizeof(value));
+            buffer[0] = static_cast<char>(value);
+            body = std::string_view(buffer, 1);
+            numeric = false;
+            break;
+        }
+        case 'p': {
+            uintptr_t value = 0;
+            ok = ok && read(&value, sizeof(value));
+            if (value == 0) {
+                body = "(nil)";
+            } else {
+                char* first = writeDigitsBackward(bufferEnd, value, 16, false, 1);
+                body = std::string_view(first, static_cast<size_t>(bufferEnd - first));
+                prefix = "0x";
+            }
+            numeric = false;
+            break;
+        }
+        case 's': {
+            uint32_t length = 0;
+            ok = ok && read(&length, sizeof(length)) && args.size() - next > length;
+            if (ok) {
+                body = std::string_view(args.data() + next, length);
+                next += length + 1;
+                if (precision >= 0 && static_cast<size_t>(precision) < body.size()) {
+                    body = body.substr(0, static_cast<size_t>(precision));
+                }
+            }
+            numeric = false;
+            break;
+        }
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': {
+            double value = 0;
+            if (longDouble) {
+                long double wide = 0;
+                ok = ok && read(&wide, sizeof(wide));
+                value = static_cast<double>(wide);
+            } else {
+                ok = ok && read(&value, sizeof(value));
+            }
+            floating = true;
+            const bool negative = std::signbit(value);
+            prefix = negative ? "-" : plus ? "+" : space ? " " : "";
+            const bool upper = conversion >= 'A' && conversion <= 'Z';
+            if (std::isnan(value)) {
+                body = upper ? "NAN" : "nan";
+                numeric = false;
+            } else if (std::isinf(value)) {
+                body = upper ? "INF" : "inf";
+                numeric = false;
+            } else {
+                body = std::string_view(buffer, formatFloat(buffer, sizeof(buffer), negative ? -value : value,
+                                                            conversion, precision, alt));
+            }
+            break;
+        }
+        default:
+            ok = false;
+            break;
+        }
+        
+        if (!ok) {
+            // Not decodable: the remaining format goes out as written
+            put(format.data() + start, format.size() - start);
+            break;
+        }
+        // As in printf, a precision turns zero padding off for integers
+        out = putField(out, end, prefix, body, width, left, zeroPad && numeric && (floating || precision < 0));
+    }
+    return out;
+}
+
+} // namespace detail
+
 } // namespace DisplayDriver
\ No newline at end of file
@@ -11,7 +11,52 @@
 #include <chrono>
 #include <memory>
 #include <functional>
-#include <fstream>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <string_view>
+#include <ostream>
+#include <algorithm>
+
+#include "log_clock.h"
+#include "log_sink.h"
+#include "log_rotation.h"
+#include "log_binary.h"
+#include "log_flight_recorder.h"
+
+// Bytes of message text stored inside each LogEntry; longer messages spill
+// into the shared MessageArena. Tunable at compile time.
+#ifndef DRIVER_LOG_INLINE_CAPACITY
+#define DRIVER_LOG_INLINE_CAPACITY 192
+#endif
+
+// Argument bytes a compact site record holds; site calls with more (long
+// string arguments) are queued as a full LogEntry instead
+#ifndef DRIVER_LOG_SITE_ARG_CAPACITY
+#define DRIVER_LOG_SITE_ARG_CAPACITY 48
+#endif
+
+// Numeric levels for preprocessor use; must match LogLevel
+#define DRIVER_LOG_LEVEL_TRACE 0
+#define DRIVER_LOG_LEVEL_DEBUG 1
+#define DRIVER_LOG_LEVEL_INFO 2
+#define DRIVER_LOG_LEVEL_WARNING 3
+#define DRIVER_LOG_LEVEL_ERROR 4
+#define DRIVER_LOG_LEVEL_CRITICAL 5
+#define DRIVER_LOG_LEVEL_OFF 6
+
+// DRIVER_LOG_* macros below this level compile to nothing (arguments are
+// not evaluated). Release builds drop TRACE by default, matching the
+// default runtime minimum of DEBUG.
+#ifndef DRIVER_LOG_ACTIVE_LEVEL
+#ifdef NDEBUG
+#define DRIVER_LOG_ACTIVE_LEVEL DRIVER_LOG_LEVEL_DEBUG
+#else
+#define DRIVER_LOG_ACTIVE_LEVEL DRIVER_LOG_LEVEL_TRACE
+#endif
+#endif
 
 namespace DisplayDriver {
 
@@ -24,24 +69,658 @@ enum class LogLevel {
     CRITICAL = 5
 };
 
+constexpr size_t kLogLevelCount = 6;
+
+// Shared overflow storage for messages that do not fit inline. Each thread
+// bump-allocates from its own current chunk, so the common case takes no
+// lock and no per-message heap allocation; chunks are refcounted by the
+// messages pointing into them and freed when the last one goes away.
+class MessageArena {
+public:
+    struct Chunk;
+    
+    static constexpr size_t kChunkSize = 64 * 1024;
+    
+    // Returns `size` writable bytes; `chunk` receives a reference owned by the caller
+    static char* allocate(size_t size, Chunk*& chunk);
+    static void retain(Chunk* chunk);
+    static void release(Chunk* chunk);
+};
+
+// Bump-pointer arena for payloads of one buffer generation. Everything
+// allocated from it dies together when the generation has been flushed,
+// so reset() just rewinds the cursor and keeps the blocks for reuse.
+// Not thread-safe; callers hold the owning buffer's lock.
+class PayloadArena {
+public:
+    static constexpr size_t kBlockSize = 256 * 1024;
+    
+    PayloadArena() = default;
+    PayloadArena(const PayloadArena&) = delete;
+    PayloadArena& operator=(const PayloadArena&) = delete;
+    
+    char* allocate(size_t size);
+    void reset();
+    
+    size_t bytesUsed() const { return m_bytesUsed; }
+    size_t bytesReserved() const { return m_bytesReserved; }
+
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+    
+    std::vector<Block> m_blocks;
+    size_t m_currentBlock = 0;
+    size_t m_offset = 0;
+    size_t m_bytesUsed = 0;
+    size_t m_bytesReserved = 0;
+};
+
+// Message text with fixed-capacity inline storage and arena overflow.
+// Overflow bytes are never modified once written, so copies share them.
+// Text placed in a PayloadArena is borrowed: moves keep pointing into the
+// arena, while copies take their own storage so they may outlive a flush.
+class LogMessage {
+public:
+    static constexpr size_t kInlineCapacity = DRIVER_LOG_INLINE_CAPACITY;
+    
+    LogMessage() noexcept : m_chunk(nullptr), m_overflow(nullptr), m_size(0) {}
+    explicit LogMessage(std::string_view text) : LogMessage() { assign(text); }
+    
+    LogMessage(const LogMessage& other) : LogMessage() { *this = other; }
+    LogMessage(LogMessage&& other) noexcept : LogMessage() { *this = std::move(other); }
+    ~LogMessage() { reset(); }
+    
+    LogMessage& operator=(const LogMessage& other) {
+        if (this != &other) {
+            reset();
+            if (other.m_chunk) {
+                MessageArena::retain(other.m_chunk);
+                m_chunk = other.m_chunk;
+                m_overflow = other.m_overflow;
+            } else if (other.m_overflow) {
+                assign(other.view());
+                return *this;
+            } else {
+                std::memcpy(m_inline, other.m_inline, other.m_size);
+            }
+            m_size = other.m_size;
+        }
+        return *this;
+    }
+    
+    LogMessage& operator=(LogMessage&& other) noexcept {
+        if (this != &other) {
+            reset();
+            if (other.m_overflow) {
+                m_chunk = other.m_chunk;
+                m_overflow = other.m_overflow;
+                other.m_chunk = nullptr;
+                other.m_overflow = nullptr;
+            } else {
+                std::memcpy(m_inline, other.m_inline, other.m_size);
+            }
+            m_size = other.m_size;
+            other.m_size = 0;
+        }
+        return *this;
+    }
+    
+    LogMessage& operator=(std::string_view text) {
+        assign(text);
+        return *this;
+    }
+    
+    void assign(std::string_view text) {
+        char* out = resize(text.size());
+        if (!text.empty()) {
+            std::memcpy(out, text.data(), text.size());
+        }
+    }
+    
+    // Long text is borrowed from `arena` and valid until the arena is reset
+    void assign(std::string_view text, PayloadArena& arena) {
+        reset();
+        m_size = static_cast<uint32_t>(text.size());
+        char* out = m_inline;
+        if (text.size() > kInlineCapacity) {
+            out = m_overflow = arena.allocate(text.size());
+        }
+        if (!text.empty()) {
+            std::memcpy(out, text.data(), text.size());
+        }
+    }
+    
+    // Discards the current contents and returns `size` writable bytes
+    char* resize(size_t size) {
+        reset();
+        m_size = static_cast<uint32_t>(size);
+        if (size <= kInlineCapacity) {
+            return m_inline;
+        }
+        m_overflow = MessageArena::allocate(size, m_chunk);
+        return m_overflow;
+    }
+    
+    const char* data() const { return m_overflow ? m_overflow : m_inline; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    bool isInline() const { return m_overflow == nullptr; }
+    bool isBorrowed() const { return m_overflow && !m_chunk; }  // Text lives in a PayloadArena
+    size_t overflowBytes() const { return m_overflow ? m_size : 0; }
+    
+    std::string_view view() const { return std::string_view(data(), m_size); }
+    std::string str() const { return std::string(data(), m_size); }
+    operator std::string_view() const { return view(); }
+    
+    friend bool operator==(const LogMessage& a, std::string_view b) { return a.view() == b; }
+    friend bool operator!=(const LogMessage& a, std::string_view b) { return a.view() != b; }
+    friend std::ostream& operator<<(std::ostream& os, const LogMessage& message) {
+        return os.write(message.data(), static_cast<std::streamsize>(message.size()));
+    }
+
+private:
+    void reset() {
+        if (m_chunk) {
+            MessageArena::release(m_chunk);
+            m_chunk = nullptr;
+        }
+        m_overflow = nullptr;
+        m_size = 0;
+    }
+    
+    MessageArena::Chunk* m_chunk;  // Null for inline or borrowed text
+    char* m_overflow;
+    uint32_t m_size;
+    char m_inline[kInlineCapacity];
+};
+
+// Renders a deferred entry: decodes the serialized arguments in `args`
+// and formats them with the printf-style `format`.
+using DeferredFormatter = std::string (*)(const char* format, const char* args);
+
+namespace detail {
+
+// printf into a std::string of exactly the required length (no truncation)
+std::string formatPrintf(const char* format, ...);
+
+// Renders serialized arguments with their format into [out, end) without
+// allocating, locking or calling printf, for the emergency flush and for
+// flight recorder dumps, where the formatter is out of reach. Conversions
+// follow printf except that floating point keeps at most 17 significant
+// digits, %f from 1e17 up and %a print like %e. Arguments that run out or a
+// conversion it does not know leave the rest of the format as it is.
+// Returns the end of the text.
+char* renderDeferred(char* out, char* end, std::string_view format, std::string_view args);
+
+// The type printf receives a variadic argument as: small integers, bool and
+// enums become int (or their wider underlying type), float becomes double
+template<typename T, typename Enable = void>
+struct PromotedArg {
+    using type = T;
+};
+template<typename T>
+struct PromotedArg<T, std::enable_if_t<std::is_integral<T>::value>> {
+    using type = std::conditional_t<(sizeof(T) < sizeof(int)), int, T>;
+};
+template<typename T>
+struct PromotedArg<T, std::enable_if_t<std::is_enum<T>::value>> : PromotedArg<std::underlying_type_t<T>> {};
+template<>
+struct PromotedArg<float> {
+    using type = double;
+};
+
+// Binary encoding of one deferred argument. Numbers and pointers are stored
+// as raw bytes of their promoted type, so the format alone tells the layout
+// (see renderDeferred); strings are copied (u32 length + bytes + NUL) so the
+// caller's buffer may be reused as soon as log() returns.
+template<typename T, typename Enable = void>
+struct DeferredArg {
+    // Only what printf has conversions for; a struct would reach it as raw bytes
+    static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value,
+                  "Deferred log arguments must be numbers, enums, pointers or strings");
+    using Decoded = typename PromotedArg<T>::type;
+    
+    static size_t size(const T&) { return sizeof(Decoded); }
+    static char* write(char* out, const T& value) {
+        const Decoded promoted = static_cast<Decoded>(value);
+        std::memcpy(out, &promoted, sizeof(Decoded));
+        return out + sizeof(Decoded);
+    }
+    static Decoded read(const char*& in) {
+        Decoded value;
+        std::memcpy(&value, in, sizeof(Decoded));
+        in += sizeof(Decoded);
+        return value;
+    }
+};
+
+struct DeferredStringArg {
+    using Decoded = const char*;
+    
+    static size_t size(std::string_view value) { return sizeof(uint32_t) + value.size() + 1; }
+    static char* write(char* out, std::string_view value) {
+        uint32_t length = static_cast<uint32_t>(value.size());
+        std::memcpy(out, &length, sizeof(length));
+        std::memcpy(out + sizeof(length), value.data(), value.size());
+        out[sizeof(length) + value.size()] = '\0';
+        return out + size(value);
+    }
+    // Null C strings render as glibc printf does instead of reaching strlen
+    static size_t size(const char* value) { return size(nonNull(value)); }
+    static char* write(char* out, const char* value) { return write(out, nonNull(value)); }
+    static const char* read(const char*& in) {
+        uint32_t length;
+        std::memcpy(&length, in, sizeof(length));
+        const char* value = in + sizeof(length);
+        in += sizeof(length) + length + 1;
+        return value;
+    }
+
+private:
+    static std::string_view nonNull(const char* value) { return value ? value : "(null)"; }
+};
+
+template<> struct DeferredArg<const char*> : DeferredStringArg {};
+template<> struct DeferredArg<char*> : DeferredStringArg {};
+template<> struct DeferredArg<std::string> : DeferredStringArg {};
+template<> struct DeferredArg<std::string_view> : DeferredStringArg {};
+
+template<typename... Args>
+LogMessage serializeArgs(const Args&... args) {
+    LogMessage payload;
+    char* out = payload.resize((size_t{0} + ... + DeferredArg<std::decay_t<Args>>::size(args)));
+    ((out = DeferredArg<std::decay_t<Args>>::write(out, args)), ...);
+    (void)out;
+    return payload;
+}
+
+// Compiled-out sites pass their arguments here from a branch never taken,
+// so they stay type-checked and count as used
+template<typename... Args>
+inline void discardLogArgs(const Args&...) {}
+
+template<typename... Args>
+std::string formatDeferred(const char* format, const char* args) {
+    // Braced initialization guarantees left-to-right decoding
+    std::tuple<typename DeferredArg<Args>::Decoded...> values{DeferredArg<Args>::read(args)...};
+    (void)args;
+    return std::apply([format](auto... decoded) { return formatPrintf(format, decoded...); }, values);
+}
+
+// For formats serialized in front of their arguments (see BufferedLogger::log);
+// the entry's own format pointer is null
+template<typename... Args>
+std::string formatCopiedDeferred(const char*, const char* args) {
+    const char* format = DeferredStringArg::read(args);
+    return formatDeferred<Args...>(format, args);
+}
+
+// Compile-time printf check for the DRIVER_LOG_SITE macros, whose formats are
+// literals: every conversion needs an argument of its kind and (promoted)
+// size, since formatDeferred hands the decoded values straight to printf.
+enum class FormatArgKind { Integer, Floating, String, Pointer };
+
+struct FormatArg {
+    FormatArgKind kind;
+    size_t size;
+};
+
+template<typename... Args>
+struct FormatArgList {};
+
+// Only named in decltype, so the macro arguments are never evaluated
+template<typename... Args>
+FormatArgList<std::decay_t<Args>...> formatArgList(const Args&...);
+
+template<typename T>
+constexpr FormatArg formatArg() {
+    if constexpr (std::is_same<T, const char*>::value || std::is_same<T, char*>::value ||
+                  std::is_same<T, std::string>::value || std::is_same<T, std::string_view>::value) {
+        return {FormatArgKind::String, 0};
+    } else if constexpr (std::is_pointer<T>::value) {
+        return {FormatArgKind::Pointer, sizeof(T)};
+    } else if constexpr (std::is_floating_point<T>::value) {
+        return {FormatArgKind::Floating, std::max(sizeof(T), sizeof(double))};
+    } else {
+        return {FormatArgKind::Integer, std::max(sizeof(T), sizeof(int))};
+    }
+}
+
+constexpr bool formatMatches(const char* format, const FormatArg* args, size_t count) {
+    auto isDigit = [](char c) { return c >= '0' && c <= '9'; };
+    size_t next = 0;
+    auto take = [&](FormatArgKind kind, size_t size) {
+        if (next == count || args[next].kind != kind || (size != 0 && args[next].size != size)) {
+            return false;
+        }
+        next++;
+        return true;
+    };
+    for (const char* p = format; *p; p++) {
+        if (*p != '%') {
+            continue;
+        }
+        if (*++p == '%') {
+            continue;
+        }
+        while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0') {
+            p++;
+        }
+        for (int field = 0; field < 2; field++) {  // Width, then precision
+            if (field == 1) {
+                if (*p != '.') {
+                    break;
+                }
+                p++;
+            }
+            if (*p == '*') {
+                if (!take(FormatArgKind::Integer, sizeof(int))) {
+                    return false;
+                }
+                p++;
+            }
+            while (isDigit(*p)) {
+                p++;
+            }
+        }
+        size_t integerSize = sizeof(int);
+        size_t floatingSize = sizeof(double);
+        if (*p == 'h') {
+            p += p[1] == 'h' ? 2 : 1;
+        } else if (*p == 'l' && p[1] == 'l') {
+            integerSize = sizeof(long long);
+            p += 2;
+        } else if (*p == 'l' || *p == 'z' || *p == 'j' || *p == 't' || *p == 'L') {
+            integerSize = *p == 'l' ? sizeof(long) : *p == 'z' ? sizeof(size_t)
+                        : *p == 'j' ? sizeof(intmax_t) : sizeof(ptrdiff_t);
+            floatingSize = *p == 'L' ? sizeof(long double) : floatingSize;
+            p++;
+        }
+        bool matched = false;
+        switch (*p) {
+        case 'd': case 'i': case 'u': case 'o': case 'x': case 'X': case 'c':
+            matched = take(FormatArgKind::Integer, integerSize);
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            matched = take(FormatArgKind::Floating, floatingSize);
+            break;
+        case 's':
+            matched = take(FormatArgKind::String, 0);
+            break;
+        case 'p':
+            matched = take(FormatArgKind::Pointer, 0);
+            break;
+        default:
+            return false;  // %n, positional arguments or a cut-off conversion
+        }
+        if (!matched) {
+            return false;
+        }
+    }
+    return next == count;
+}
+
+template<typename... Args>
+constexpr bool formatMatches(const char* format, FormatArgList<Args...>) {
+    const FormatArg args[sizeof...(Args) + 1] = {formatArg<Args>()..., {FormatArgKind::Integer, 0}};
+    return formatMatches(format, args, sizeof...(Args));
+}
+
+} // namespace detail
+
+// Static metadata for one logging call site. Instances are function-local
+// statics created by DRIVER_LOG_SITE and registered once, so a record carries
+// the 32-bit site id plus argument bytes instead of format, file and line
+// (see SiteRecord).
+class LogSite {
+public:
+    LogSite(LogLevel level, const char* file, int line, const char* format);
+    
+    uint32_t id() const { return m_id; }
+    LogLevel level() const { return m_level; }
+    const char* file() const { return m_file; }
+    int line() const { return m_line; }
+    const char* format() const { return m_format; }
+    
+    bool enabled() const { return m_enabled.load(std::memory_order_relaxed); }
+    void setEnabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+    
+    DeferredFormatter formatter() const { return m_formatter.load(std::memory_order_acquire); }
+    
+    // Argument types are fixed per site, so every call binds the same formatter
+    void bindFormatter(DeferredFormatter formatter) {
+        if (!m_formatter.load(std::memory_order_relaxed)) {
+            m_formatter.store(formatter, std::memory_order_release);
+        }
+    }
+
+private:
+    uint32_t m_id;
+    LogLevel m_level;
+    const char* m_file;
+    int m_line;
+    const char* m_format;
+    std::atomic<bool> m_enabled{true};
+    std::atomic<DeferredFormatter> m_formatter{nullptr};
+};
+
+// Token bucket for one call site: `burst` entries at once, refilled at
+// `perSecond`. Stored as the single time at which the bucket runs empty, so
+// taking a token is one CAS and refilling is implicit in each caller's clock
+// read: no refill thread and no lock. A rejected call costs a clock read and
+// a counter increment.
+class LogRateLimit {
+public:
+    LogRateLimit(double perSecond, uint32_t burst)
+        : m_intervalNs(static_cast<int64_t>(1e9 / std::max(perSecond, 1e-9))),
+          m_burstNs(m_intervalNs * std::max<uint32_t>(burst, 1)) {}
+    
+    bool tryAcquire() {
+        const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        int64_t emptyAt = m_emptyAt.load(std::memory_order_relaxed);
+        for (;;) {
+            const int64_t next = std::max(emptyAt, now) + m_intervalNs;
+            if (next - now > m_burstNs) {
+                return false;
+            }
+            if (m_emptyAt.compare_exchange_weak(emptyAt, next, std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+    }
+    
+    // Rejections are counted per logger (by instance id), since loggers
+    // sharing a site report them separately. False when `logger` holds no
+    // counter here yet: it then calls claimSuppressed() under its own lock.
+    bool countSuppressed(uint64_t logger) {
+        for (auto& slot : m_suppressed) {
+            if (slot.logger.load(std::memory_order_relaxed) == logger) {
+                slot.count.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    // Counts one rejection in a free counter taken for `logger`; false when
+    // kLoggerSlots other loggers hold them all
+    bool claimSuppressed(uint64_t logger) {
+        if (countSuppressed(logger)) {
+            return true;  // Another thread of the same logger claimed one
+        }
+        for (auto& slot : m_suppressed) {
+            uint64_t expected = 0;
+            if (slot.logger.compare_exchange_strong(expected, logger, std::memory_order_relaxed)) {
+                slot.count.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    // `logger`'s rejections since its last takeSuppressed()
+    bool hasSuppressed(uint64_t logger) const {
+        for (const auto& slot : m_suppressed) {
+            if (slot.logger.load(std::memory_order_relaxed) == logger) {
+                return slot.count.load(std::memory_order_relaxed) != 0;
+            }
+        }
+        return false;
+    }
+    uint64_t takeSuppressed(uint64_t logger) {
+        for (auto& slot : m_suppressed) {
+            if (slot.logger.load(std::memory_order_relaxed) == logger) {
+                return slot.count.exchange(0, std::memory_order_relaxed);
+            }
+        }
+        return 0;
+    }
+    
+    // Frees `logger`'s counter once it has reported it for the last time
+    void releaseSuppressed(uint64_t logger) {
+        for (auto& slot : m_suppressed) {
+            if (slot.logger.load(std::memory_order_relaxed) == logger) {
+                slot.count.store(0, std::memory_order_relaxed);
+                slot.logger.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    static constexpr size_t kLoggerSlots = 4;
+    
+    struct SuppressedCount {
+        std::atomic<uint64_t> logger{0};  // Instance id; 0 while free
+        std::atomic<uint64_t> count{0};
+    };
+    
+    const int64_t m_intervalNs;  // One token
+    const int64_t m_burstNs;     // Bucket capacity
+    std::atomic<int64_t> m_emptyAt{0};
+    alignas(64) SuppressedCount m_suppressed[kLoggerSlots];  // Rejections keep off the CAS line
+};
+
+class LogSiteRegistry {
+public:
+    static LogSiteRegistry& instance();
+    
+    uint32_t add(LogSite* site);
+    const LogSite* find(uint32_t id) const;
+    const LogSite* tryFind(uint32_t id) const;  // Null rather than wait for the lock (signal handlers)
+    size_t size() const;
+    
+    // Enables/disables sites whose file ends with `file`; line 0 matches every line
+    size_t setEnabled(const char* file, int line, bool enabled);
+
+private:
+    mutable std::mutex m_mutex;
+    std::vector<LogSite*> m_sites;  // Index = id - 1; sites are never removed
+};
+
+class LogCategory;
+
 struct LogEntry {
-    std::chrono::steady_clock::time_point timestamp;
+    std::chrono::steady_clock::time_point timestamp;  // Converted from `ticks` on flush
     LogLevel level;
-    std::string message;
+    LogMessage message;  // Serialized arguments while the entry is still deferred
     std::thread::id threadId;
-    uint32_t hash;
+    uint64_t hash;
     size_t count;  // For deduplication tracking
+    const char* format = nullptr;            // Resolved site entries; BufferedLogger::log keeps it in `message`
+    DeferredFormatter formatter = nullptr;   // Cleared once the flush thread renders the text
+    uint32_t siteId = 0;                     // Registered call site (format comes from the registry)
+    const LogCategory* category = nullptr;   // Null for the logger's own (root) messages
+    uint64_t ticks = 0;                      // Raw capture in the logger's Config::clockSource
     
     LogEntry() : level(LogLevel::INFO), hash(0), count(1) {}
-    LogEntry(LogLevel lvl, const std::string& msg, uint32_t h = 0) 
-        : timestamp(std::chrono::steady_clock::now()), 
-          level(lvl), 
+    LogEntry(LogLevel lvl, std::string_view msg, uint64_t h = 0) 
+        : level(lvl), 
           message(msg), 
           threadId(std::this_thread::get_id()),
           hash(h),
           count(1) {}
 };
 
+// A site call while it waits for the flush: site id, capture time, thread
+// and packed arguments, about a third of a LogEntry slot. Queued apart from
+// entries and expanded into one by the flush, which also renders it.
+struct SiteRecord {
+    static constexpr size_t kArgCapacity = DRIVER_LOG_SITE_ARG_CAPACITY;
+    
+    uint64_t ticks;
+    const LogCategory* category;
+    std::thread::id threadId;
+    uint32_t siteId;
+    LogLevel level;    // The site's; the emergency flush cannot look it up
+    uint32_t argSize;
+    char args[kArgCapacity];
+};
+
+// Renders text lines of the form
+//   [YYYY-MM-DD HH:MM:SS.mmm] [LEVEL] [T:tid] [category] message (repeated N times)
+// straight into a caller-owned byte buffer. The local date/time prefix is
+// cached per wall-clock second, so most lines cost a few memcpys. Not
+// thread-safe: each consumer owns one.
+class LogLineFormatter {
+public:
+    // Appends one line including its trailing '\n'
+    void appendLine(std::string& out, const LogEntry& entry, std::chrono::system_clock::time_point wallTime);
+    
+    // Same line from its fields; `category` may be empty. Used by decoders
+    // that rebuild text from stored records.
+    void appendLine(std::string& out, LogLevel level, std::string_view threadId, std::string_view category,
+                    std::string_view message, size_t count, std::chrono::system_clock::time_point wallTime);
+    
+    // Thread id as it appears after "T:"; returns the new end of `out`
+    static char* writeThreadId(char* out, char* end, std::thread::id id);
+
+private:
+    int64_t m_cachedSecond = -1;
+    char m_cachedDate[19];  // "YYYY-MM-DD HH:MM:SS"
+};
+
+class ThreadRing;
+template <typename T> class MpscQueue;
+class DedupTable;
+class LogPipeline;
+
+// Producer-side queueing strategy
+enum class QueueType {
+    SharedBuffer,   // Single mutex-guarded buffer shared by all producers
+    PerThreadRing,  // Lock-free SPSC ring per producer thread, drained by the flush worker
+    BoundedMpsc     // One bounded lock-free MPSC queue shared by all producers
+};
+
+// What a producer does once the entries awaiting flush reach
+// Config::maxPendingEntries or maxPendingBytes
+enum class OverflowPolicy {
+    Grow,            // Keep buffering: no bound while the flush catches up
+    Block,           // Wait up to overflowBlockTimeout for the flush to make room, then drop
+    DropNewest,      // Drop the entry being logged
+    DropOldest,      // Overwrite the oldest pending entry in the shared buffer
+    DropBelowLevel   // Drop entries below overflowKeepLevel; keep the rest (over the limit)
+};
+
+// Why an entry was dropped (Stats::droppedByReason index)
+enum class DropReason {
+    Full,        // DropNewest, or DropOldest with nothing in the shared buffer to evict
+    Evicted,     // DropOldest: overwritten by a newer entry
+    BelowLevel,  // DropBelowLevel
+    Timeout      // Block: no room within overflowBlockTimeout
+};
+
+constexpr size_t kDropReasonCount = 4;
+
+// File output encoding
+enum class OutputFormat {
+    Text,    // Human-readable lines
+    Binary   // Raw records (see log_binary.h); convert with log_decode
+};
+
 class BufferedLogger {
 public:
     struct Config {
@@ -51,10 +730,30 @@ public:
         bool enableDeduplication = true;
         size_t deduplicationWindowSize = 1000;  // Last N unique messages to track
         std::chrono::milliseconds deduplicationTimeWindow = std::chrono::milliseconds(5000);
-        LogLevel minimumLevel = LogLevel::DEBUG;
+        LogLevel minimumLevel = LogLevel::DEBUG;  // Initial root level; change with setMinimumLevel
         std::string outputFile = "driver.log";
         bool consoleOutput = false;
+        bool consoleThread = false;             // Console writes on their own thread; a stalled console drops batches
         bool asyncFlush = true;
+        QueueType queueType = QueueType::SharedBuffer;
+        size_t threadRingCapacity = 4096;       // Per-thread ring slots (rounded up to a power of two)
+        size_t mpscQueueCapacity = 16384;       // Shared MPSC queue slots (rounded up to a power of two)
+        ClockSource clockSource = ClockSource::SteadyClock;  // Timestamp capture on the hot path
+        size_t outputBlockSize = 64 * 1024;     // Rendered bytes per output block (one iovec each)
+        FileSinkType fileSinkType = FileSinkType::Writev;
+        size_t ioUringQueueDepth = 8;           // Writes in flight for FileSinkType::IoUring
+        size_t mmapChunkSize = 64 * 1024 * 1024; // Preallocation step for FileSinkType::Mmap
+        RotationPolicy rotation;                // Disabled unless maxBytes or maxAge is set
+        bool compressOutput = false;            // Write framed LZ blocks; read with log_decompress
+        OutputFormat outputFormat = OutputFormat::Text;  // Console output stays text either way
+        std::string flightRecorderFile;         // Crash-persistent ring of recent entries (empty = off)
+        size_t flightRecorderEntries = 4096;    // Ring slots (rounded up to a power of two)
+        bool emergencyFlushOnCrash = false;     // Write pending entries on SIGSEGV, SIGABRT, ... (see emergencyFlush)
+        OverflowPolicy overflowPolicy = OverflowPolicy::Grow;
+        size_t maxPendingEntries = 0;           // Hard limit for overflowPolicy (0 = 2 * bufferSize)
+        size_t maxPendingBytes = 0;             // Hard limit for overflowPolicy (0 = 2 * maxMemoryBytes)
+        std::chrono::milliseconds overflowBlockTimeout = std::chrono::milliseconds(10);
+        LogLevel overflowKeepLevel = LogLevel::WARNING;  // DropBelowLevel never drops these
     };
 
     explicit BufferedLogger(const Config& config = Config());
@@ -67,24 +766,79 @@ public:
     BufferedLogger& operator=(BufferedLogger&&) = default;
 
     // Core logging methods
-    void log(LogLevel level, const std::string& message);
-    void log(LogLevel level, const char* format, ...);
+    void log(LogLevel level, std::string_view message);
+    
+    // printf-style logging with deferred formatting: arguments are captured
+    // in binary and the text is rendered on the flush thread. The format is
+    // copied along with them, so it may be built at run time; DRIVER_LOG_SITE
+    // skips that copy for literal formats and checks them at compile time.
+    // Calls without arguments take the string_view overload above.
+    template<typename... Args, typename = std::enable_if_t<(sizeof...(Args) > 0)>>
+    void log(LogLevel level, const char* format, const Args&... args) {
+        if (!isEnabled(level)) {
+            return;
+        }
+        
+        logDeferred(nullptr, level, format, &detail::formatCopiedDeferred<std::decay_t<Args>...>,
+                    detail::serializeArgs(format, args...));
+    }
+    
+    // Log through a registered call site (see DRIVER_LOG_SITE)
+    template<typename... Args>
+    void logSite(LogSite& site, const Args&... args) {
+        if (!isEnabled(site.level())) {
+            return;
+        }
+        
+        site.bindFormatter(&detail::formatDeferred<std::decay_t<Args>...>);
+        logSiteRecord(nullptr, site, detail::serializeArgs(args...));
+    }
+    
+    // Rate-limit check for DRIVER_LOG_SITE_LIMITED, made before the arguments
+    // are evaluated. The first call let through after rejections logs a
+    // summary of them first.
+    bool admitRateLimited(const LogSite& site, LogRateLimit& limit) {
+        return passRateLimit(nullptr, site, limit);
+    }
+    
+    // Runtime level check, cheap enough to guard argument construction
+    bool isEnabled(LogLevel level) const {
+        return level >= m_minimumLevel.load(std::memory_order_relaxed);
+    }
     
     // Convenience methods
-    void trace(const std::string& msg) { log(LogLevel::TRACE, msg); }
-    void debug(const std::string& msg) { log(LogLevel::DEBUG, msg); }
-    void info(const std::string& msg) { log(LogLevel::INFO, msg); }
-    void warning(const std::string& msg) { log(LogLevel::WARNING, msg); }
-    void error(const std::string& msg) { log(LogLevel::ERROR, msg); }
-    void critical(const std::string& msg) { log(LogLevel::CRITICAL, msg); }
+    void trace(std::string_view msg) { log(LogLevel::TRACE, msg); }
+    void debug(std::string_view msg) { log(LogLevel::DEBUG, msg); }
+    void info(std::string_view msg) { log(LogLevel::INFO, msg); }
+    void warning(std::string_view msg) { log(LogLevel::WARNING, msg); }
+    void error(std::string_view msg) { log(LogLevel::ERROR, msg); }
+    void critical(std::string_view msg) { log(LogLevel::CRITICAL, msg); }
 
     // Flush control
     void flush();
     void forceFlush();  // Bypasses async and flushes immediately
     
+    // Last-resort flush for fatal signal handlers. Async-signal-safe: writes
+    // every pending entry as text with write(2) only, from memory reserved at
+    // construction, and does not wait on locks a crashed thread may hold.
+    // Entries a flush already took are left to that flush. Deferred entries
+    // print their format string, not the arguments. Runs once per logger,
+    // and only with Config::emergencyFlushOnCrash set, which also installs
+    // the handler that calls it.
+    void emergencyFlush() noexcept;
+    
     // Configuration
     void setMinimumLevel(LogLevel level);
+    LogLevel minimumLevel() const { return m_minimumLevel.load(std::memory_order_relaxed); }
+    
+    // Named categories ("display.vsync") share this logger's buffers and
+    // output. The first lookup creates the category and any missing ancestors;
+    // references stay valid for the logger's lifetime, so callers keep them.
+    LogCategory& category(std::string_view name);
+    void setCategoryLevel(std::string_view name, LogLevel level);
     void enableDeduplication(bool enable);
+    // Runs inline on the flush path; heavy consumers belong in a sink with
+    // its own thread (sinks().add with SinkOptions::dedicatedThread)
     void setFlushCallback(std::function<void(const std::vector<LogEntry>&)> callback);
     
     // Statistics
@@ -93,27 +847,89 @@ public:
         std::atomic<size_t> totalFlushed{0};
         std::atomic<size_t> totalDeduplicated{0};
         std::atomic<size_t> currentBufferSize{0};
+        std::atomic<size_t> currentBufferedBytes{0};  // Entry slots plus out-of-line text awaiting flush
         std::atomic<size_t> totalFlushes{0};
+        std::atomic<size_t> outputSyscalls{0};  // System calls issued by the file sink
+        std::atomic<size_t> outputBytes{0};     // Bytes added to output files (no padding or rewrites)
+        std::atomic<size_t> renderedBytes{0};   // Text bytes before compression
+        std::atomic<size_t> totalRotations{0};
+        std::atomic<size_t> totalRateLimited{0};  // Rejected by call-site rate limits (DRIVER_LOG_SITE_LIMITED)
+        std::atomic<size_t> totalDropped{0};    // By Config::overflowPolicy; reported in the log on the next flush
+        std::atomic<size_t> droppedByLevel[kLogLevelCount] = {};
+        std::atomic<size_t> droppedByReason[kDropReasonCount] = {};
         std::chrono::steady_clock::time_point lastFlushTime;
     };
     
     const Stats& getStats() const { return m_stats; }
     
+    // Further outputs fed from every flush, each with its own level filter
+    // and optional thread (see log_pipeline.h). The console is one of them.
+    LogPipeline& sinks() { return *m_pipeline; }
+    const char* fileSinkName() const { return m_fileSink ? m_fileSink->name() : "none"; }
+    
     // Shutdown
     void shutdown();
 
 private:
+    friend class LogCategory;
+    
     // Internal methods
-    void internalLog(const LogEntry& entry);
+    void logText(const LogCategory* category, LogLevel level, std::string_view message);
+    void logDeferred(const LogCategory* category, LogLevel level, const char* format,
+                     DeferredFormatter formatter, LogMessage&& args);
+    void logSiteRecord(const LogCategory* category, const LogSite& site, LogMessage&& args);
+    bool passRateLimit(const LogCategory* category, const LogSite& site, LogRateLimit& limit) {
+        if (!limit.tryAcquire()) {
+            m_stats.totalRateLimited.fetch_add(1, std::memory_order_relaxed);
+            if (!limit.countSuppressed(m_instanceId)) {
+                trackRateLimit(category, site, limit);
+            }
+            return false;
+        }
+        if (limit.hasSuppressed(m_instanceId)) {
+            reportSuppressed(category, site, limit);
+        }
+        return true;
+    }
+    void reportSuppressed(const LogCategory* category, const LogSite& site, LogRateLimit& limit);
+    void trackRateLimit(const LogCategory* category, const LogSite& site, LogRateLimit& limit);
+    void takeRateLimitReports(std::vector<LogEntry>& out);
+    bool internalLog(LogEntry&& entry, std::string_view text = std::string_view());
+    bool internalLog(SiteRecord&& record);
+    bool reserveQueued(size_t bytes);
+    void releaseQueued(size_t bytes);
+    void enqueueShared(LogEntry&& entry, std::string_view text);
+    void enqueueShared(SiteRecord&& record);
+    bool overLimit(size_t bytes) const;
+    bool applyOverflowPolicy(LogEntry& entry, std::string_view text, size_t bytes, bool& stored);
+    bool evictOldest(LogEntry&& entry, std::string_view text);
+    void recordDrop(LogLevel level, DropReason reason);
+    void requestFlush();
+    ThreadRing* acquireThreadRing();
+    size_t drainThreadRings(std::vector<LogEntry>& out, std::vector<SiteRecord>& records);
     void flushWorker();
     void performFlush();
-    uint32_t computeHash(const std::string& message, LogLevel level);
-    bool shouldDeduplicate(uint32_t hash, std::chrono::steady_clock::time_point now);
-    std::string formatLogEntry(const LogEntry& entry);
-    size_t estimateMemoryUsage() const;
+    uint64_t computeHash(std::string_view message, LogLevel level, uint64_t seed = 0);
+    bool shouldDeduplicate(uint64_t hash, uint64_t nowTicks);
+    static void resolveDeferred(LogEntry& entry);
+    void updateCategoryLevels();
+    void writeOutputBlocks(size_t count);
+    void publishToSinks(const std::vector<LogEntry>& entries);
+    void openFileSink();
+    void rotateFile();
+    void publishSinkStats();
     
     // Configuration
     Config m_config;
+    std::atomic<LogLevel> m_minimumLevel;  // Root level; read racily by every producer
+    
+    // Producers read ticks; the flush path recalibrates and converts them
+    ClockCalibration m_clock;
+    std::atomic<int64_t> m_dedupWindowTicks;
+    
+    // Categories in creation order, so parents always precede their children
+    std::mutex m_categoriesMutex;
+    std::vector<std::unique_ptr<LogCategory>> m_categories;
     
     // Thread safety
     mutable std::mutex m_bufferMutex;
@@ -121,34 +937,173 @@ private:
     std::condition_variable m_flushCv;
     std::condition_variable m_shutdownCv;
     
-    // Buffers (double buffering for performance)
-    std::vector<LogEntry> m_primaryBuffer;
-    std::vector<LogEntry> m_secondaryBuffer;
+    // One buffer generation: entries plus the arena holding their long payloads
+    struct LogBuffer {
+        std::vector<LogEntry> entries;
+        std::vector<SiteRecord> records;  // Site calls in compact form, expanded by the flush
+        PayloadArena arena;
+        size_t nextEviction = 0;  // OverflowPolicy::DropOldest overwrites entries round-robin from here
+        bool evicted = false;     // Entries are out of order until the flush sorts them
+        size_t strandedBytes = 0; // Arena text of evicted entries, still held until the arena resets
+    };
+    
+    // Buffers (double buffering for performance). Producers append to the
+    // active generation under m_bufferMutex; the flush path owns the other
+    // one and resets it wholesale once written.
+    LogBuffer m_primaryBuffer;
+    LogBuffer m_secondaryBuffer;
     std::atomic<bool> m_useSecondaryBuffer{false};
+    bool m_flushInProgress = false;  // Guarded by m_consumerMutex
+    
+    // Overflow policy limits; producers waiting under Block are woken per flush
+    size_t m_maxPendingEntries;
+    size_t m_maxPendingBytes;
+    std::mutex m_spaceMutex;
+    std::condition_variable m_spaceCv;
+    std::atomic<size_t> m_droppedSinceReport{0};
     
-    // Deduplication
-    struct DedupeInfo {
-        std::chrono::steady_clock::time_point lastSeen;
-        size_t count;
+    // Rate limits that have rejected entries here, by site id; every flush
+    // reports what they still hold, so a site that went quiet is not left unreported
+    struct TrackedRateLimit {
+        const LogCategory* category;
+        const LogSite* site;
+        LogRateLimit* limit;
+        uint64_t unslotted;  // Rejections counted here when the limit had no counter free
     };
-    std::unordered_map<uint32_t, DedupeInfo> m_dedupeMap;
-    std::vector<uint32_t> m_dedupeWindow;  // Circular buffer of recent hashes
-    size_t m_dedupeWindowIndex = 0;
+    std::mutex m_rateLimitsMutex;
+    std::unordered_map<uint32_t, TrackedRateLimit> m_rateLimits;
+    std::vector<LogEntry> m_rateLimitReports;  // Flush path only; capacity is kept
+    
+    // Deduplication (lock-free; never touches m_bufferMutex)
+    std::unique_ptr<DedupTable> m_dedupTable;
+    std::atomic<bool> m_dedupEnabled;
+    
+    // Per-thread rings (QueueType::PerThreadRing)
+    std::mutex m_ringsMutex;
+    std::vector<std::shared_ptr<ThreadRing>> m_rings;
+    uint64_t m_instanceId;
+    
+    // Shared lock-free queues (QueueType::BoundedMpsc)
+    std::unique_ptr<MpscQueue<LogEntry>> m_mpscQueue;
+    std::unique_ptr<MpscQueue<SiteRecord>> m_mpscRecords;
+    
+    std::recursive_mutex m_consumerMutex;  // Serializes flushes; rings and queue need a single consumer
     
     // Flush thread
     std::unique_ptr<std::thread> m_flushThread;
     std::atomic<bool> m_shutdown{false};
     std::atomic<bool> m_forceFlushRequested{false};
     
-    // Output
-    std::ofstream m_fileStream;
+    // Output; the formatter and blocks belong to the flush path
+    std::unique_ptr<LogSink> m_fileSink;
+    std::unique_ptr<LogRotator> m_rotator;
+    std::unique_ptr<FlightRecorder> m_flightRecorder;
+    uint64_t m_fileStartBytes = 0;  // Size of the active file when it was opened
+    std::chrono::steady_clock::time_point m_fileOpenedAt;
+    size_t m_retiredSyscalls = 0;   // Counters of sinks closed by rotation
+    size_t m_retiredBytes = 0;
+    LogLineFormatter m_lineFormatter;
+    BinaryLogEncoder m_binaryEncoder;
+    std::vector<std::string> m_outputBlocks;  // Capacity is kept between flushes
+    std::vector<std::string_view> m_outputViews;
     std::function<void(const std::vector<LogEntry>&)> m_flushCallback;
+    std::unique_ptr<LogPipeline> m_pipeline;
+    
+    // Emergency flush; everything the signal path touches is set up front
+    std::string m_emergencyPath;           // Opened at crash time; empty = stderr
+    std::unique_ptr<char[]> m_emergencyBuffer;
+    int64_t m_utcOffsetSeconds = 0;        // localtime_r is not signal-safe
+    std::atomic<bool> m_emergencyFlushed{false};
+    std::atomic<bool> m_emergencyReading{false};  // The handler is reading m_flushProgress.entries
+    
+    // The retired generation while a flush renders and writes it: entries
+    // [written, count) have not reached the sink yet; those from `resolved`
+    // on are still deferred
+    struct FlushProgress {
+        std::atomic<const LogEntry*> entries{nullptr};
+        std::atomic<size_t> count{0};
+        std::atomic<size_t> resolved{0};
+        std::atomic<size_t> written{0};
+    };
+    FlushProgress m_flushProgress;
     
     // Statistics
     mutable Stats m_stats;
+};
+
+// Named subsystem logger. A category without its own level inherits the
+// nearest configured ancestor's, ending at the owner's minimum level. The
+// resolved level is cached here and refreshed whenever any level changes, so
+// isEnabled() is a single relaxed load.
+class LogCategory {
+public:
+    LogCategory(const LogCategory&) = delete;
+    LogCategory& operator=(const LogCategory&) = delete;
+    
+    const std::string& name() const { return m_name; }
+    LogCategory* parent() const { return m_parent; }
+    BufferedLogger& logger() const { return m_owner; }
+    
+    bool isEnabled(LogLevel level) const {
+        return level >= m_effectiveLevel.load(std::memory_order_relaxed);
+    }
+    LogLevel level() const { return m_effectiveLevel.load(std::memory_order_relaxed); }
+    bool hasLevel() const { return m_configuredLevel.load(std::memory_order_relaxed) != kInherit; }
+    
+    void setLevel(LogLevel level);
+    void clearLevel();  // Inherit from the parent again
     
-    // Performance optimizations
-    static thread_local char s_formatBuffer[4096];
+    void log(LogLevel level, std::string_view message) {
+        if (isEnabled(level)) {
+            m_owner.logText(this, level, message);
+        }
+    }
+    
+    // Deferred like BufferedLogger::log, format copied
+    template<typename... Args, typename = std::enable_if_t<(sizeof...(Args) > 0)>>
+    void log(LogLevel level, const char* format, const Args&... args) {
+        if (!isEnabled(level)) {
+            return;
+        }
+        
+        m_owner.logDeferred(this, level, format, &detail::formatCopiedDeferred<std::decay_t<Args>...>,
+                            detail::serializeArgs(format, args...));
+    }
+    
+    template<typename... Args>
+    void logSite(LogSite& site, const Args&... args) {
+        if (!isEnabled(site.level())) {
+            return;
+        }
+        
+        site.bindFormatter(&detail::formatDeferred<std::decay_t<Args>...>);
+        m_owner.logSiteRecord(this, site, detail::serializeArgs(args...));
+    }
+    
+    bool admitRateLimited(const LogSite& site, LogRateLimit& limit) {
+        return m_owner.passRateLimit(this, site, limit);
+    }
+    
+    void trace(std::string_view msg) { log(LogLevel::TRACE, msg); }
+    void debug(std::string_view msg) { log(LogLevel::DEBUG, msg); }
+    void info(std::string_view msg) { log(LogLevel::INFO, msg); }
+    void warning(std::string_view msg) { log(LogLevel::WARNING, msg); }
+    void error(std::string_view msg) { log(LogLevel::ERROR, msg); }
+    void critical(std::string_view msg) { log(LogLevel::CRITICAL, msg); }
+
+private:
+    friend class BufferedLogger;
+    
+    static constexpr int kInherit = -1;
+    
+    LogCategory(BufferedLogger& owner, std::string name, LogCategory* parent, LogLevel level)
+        : m_owner(owner), m_name(std::move(name)), m_parent(parent), m_effectiveLevel(level) {}
+    
+    BufferedLogger& m_owner;
+    std::string m_name;
+    LogCategory* m_parent;
+    std::atomic<int> m_configuredLevel{kInherit};  // Written under the owner's m_categoriesMutex
+    std::atomic<LogLevel> m_effectiveLevel;
 };
 
 // Singleton pattern for global logger (common in drivers)
@@ -164,13 +1119,116 @@ public:
     }
 };
 
-// Convenience macros for driver logging
-#define DRIVER_LOG_TRACE(msg) DisplayDriver::GlobalLogger::getInstance().trace(msg)
-#define DRIVER_LOG_DEBUG(msg) DisplayDriver::GlobalLogger::getInstance().debug(msg)
-#define DRIVER_LOG_INFO(msg) DisplayDriver::GlobalLogger::getInstance().info(msg)
-#define DRIVER_LOG_WARNING(msg) DisplayDriver::GlobalLogger::getInstance().warning(msg)
-#define DRIVER_LOG_ERROR(msg) DisplayDriver::GlobalLogger::getInstance().error(msg)
-#define DRIVER_LOG_CRITICAL(msg) DisplayDriver::GlobalLogger::getInstance().critical(msg)
+// Convenience macros for driver logging. Levels below DRIVER_LOG_ACTIVE_LEVEL
+// compile to nothing (arguments are referenced but never evaluated); enabled levels check the runtime level before the
+// message argument is evaluated.
+#define DRIVER_LOG_AT_(level, msg) \
+    do { \
+        auto& driverLogger_ = DisplayDriver::GlobalLogger::getInstance(); \
+        if (driverLogger_.isEnabled(level)) { \
+            driverLogger_.log((level), std::string_view(msg)); \
+        } \
+    } while (0)
+
+#define DRIVER_LOG_DISABLED_(...) \
+    do { \
+        if (false) { \
+            DisplayDriver::detail::discardLogArgs(__VA_ARGS__); \
+        } \
+    } while (0)
+
+// Rejects a format that is not a string literal or does not match its
+// arguments' types (see detail::formatMatches)
+#define DRIVER_LOG_CHECK_FORMAT_(fmt, ...) \
+    static_assert(DisplayDriver::detail::formatMatches( \
+                      "" fmt, decltype(DisplayDriver::detail::formatArgList(__VA_ARGS__)){}), \
+                  "log format does not match its arguments")
+
+// Registered call-site logging: level, file, line and format are recorded once
+// per site; arguments are skipped entirely while the site or level is disabled.
+// `logger` is a BufferedLogger or a LogCategory.
+#define DRIVER_LOG_SITE(logger, lvl, fmt, ...) \
+    do { \
+        DRIVER_LOG_CHECK_FORMAT_(fmt, ##__VA_ARGS__); \
+        static DisplayDriver::LogSite driverLogSite_((lvl), __FILE__, __LINE__, (fmt)); \
+        auto& driverLogger_ = (logger); \
+        if (driverLogSite_.enabled() && driverLogger_.isEnabled(driverLogSite_.level())) { \
+            driverLogger_.logSite(driverLogSite_, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+// DRIVER_LOG_SITE with a token bucket: at most `burst` entries at once and
+// `perSecond` sustained. Rejected calls skip argument evaluation; they are
+// counted and summarized when the site is next let through, or by the next
+// flush if that comes first.
+#define DRIVER_LOG_SITE_LIMITED(logger, lvl, perSecond, burst, fmt, ...) \
+    do { \
+        DRIVER_LOG_CHECK_FORMAT_(fmt, ##__VA_ARGS__); \
+        static DisplayDriver::LogSite driverLogSite_((lvl), __FILE__, __LINE__, (fmt)); \
+        static DisplayDriver::LogRateLimit driverLogLimit_((perSecond), (burst)); \
+        auto& driverLogger_ = (logger); \
+        if (driverLogSite_.enabled() && driverLogger_.isEnabled(driverLogSite_.level()) && \
+            driverLogger_.admitRateLimited(driverLogSite_, driverLogLimit_)) { \
+            driverLogger_.logSite(driverLogSite_, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+#define DRIVER_LOGF_AT_(level, format, ...) \
+    DRIVER_LOG_SITE(DisplayDriver::GlobalLogger::getInstance(), level, format, ##__VA_ARGS__)
+
+#define DRIVER_LOGF_DISABLED_(format, ...) \
+    do { \
+        DRIVER_LOG_CHECK_FORMAT_(format, ##__VA_ARGS__); \
+        DRIVER_LOG_DISABLED_(format, ##__VA_ARGS__); \
+    } while (0)
+
+#if DRIVER_LOG_ACTIVE_LEVEL <= DRIVER_LOG_LEVEL_TRACE
+#define DRIVER_LOG_TRACE(msg) DRIVER_LOG_AT_(DisplayDriver::LogLevel::TRACE, msg)
+#define DRIVER_LOGF_TRACE(format, ...) DRIVER_LOGF_AT_(DisplayDriver::LogLevel::TRACE, format, ##__VA_ARGS__)
+#else
+#define DRIVER_LOG_TRACE(msg) DRIVER_LOG_DISABLED_(msg)
+#define DRIVER_LOGF_TRACE(format, ...) DRIVER_LOGF_DISABLED_(format, ##__VA_ARGS__)
+#endif
+
+#if DRIVER_LOG_ACTIVE_LEVEL <= DRIVER_LOG_LEVEL_DEBUG
+#define DRIVER_LOG_DEBUG(msg) DRIVER_LOG_AT_(DisplayDriver::LogLevel::DEBUG, msg)
+#define DRIVER_LOGF_DEBUG(format, ...) DRIVER_LOGF_AT_(DisplayDriver::LogLevel::DEBUG, format, ##__VA_ARGS__)
+#else
+#define DRIVER_LOG_DEBUG(msg) DRIVER_LOG_DISABLED_(msg)
+#define DRIVER_LOGF_DEBUG(format, ...) DRIVER_LOGF_DISABLED_(format, ##__VA_ARGS__)
+#endif
+
+#if DRIVER_LOG_ACTIVE_LEVEL <= DRIVER_LOG_LEVEL_INFO
+#define DRIVER_LOG_INFO(msg) DRIVER_LOG_AT_(DisplayDriver::LogLevel::INFO, msg)
+#define DRIVER_LOGF_INFO(format, ...) DRIVER_LOGF_AT_(DisplayDriver::LogLevel::INFO, format, ##__VA_ARGS__)
+#else
+#define DRIVER_LOG_INFO(msg) DRIVER_LOG_DISABLED_(msg)
+#define DRIVER_LOGF_INFO(format, ...) DRIVER_LOGF_DISABLED_(format, ##__VA_ARGS__)
+#endif
+
+#if DRIVER_LOG_ACTIVE_LEVEL <= DRIVER_LOG_LEVEL_WARNING
+#define DRIVER_LOG_WARNING(msg) DRIVER_LOG_AT_(DisplayDriver::LogLevel::WARNING, msg)
+#define DRIVER_LOGF_WARNING(format, ...) DRIVER_LOGF_AT_(DisplayDriver::LogLevel::WARNING, format, ##__VA_ARGS__)
+#else
+#define DRIVER_LOG_WARNING(msg) DRIVER_LOG_DISABLED_(msg)
+#define DRIVER_LOGF_WARNING(format, ...) DRIVER_LOGF_DISABLED_(format, ##__VA_ARGS__)
+#endif
+
+#if DRIVER_LOG_ACTIVE_LEVEL <= DRIVER_LOG_LEVEL_ERROR
+#define DRIVER_LOG_ERROR(msg) DRIVER_LOG_AT_(DisplayDriver::LogLevel::ERROR, msg)
+#define DRIVER_LOGF_ERROR(format, ...) DRIVER_LOGF_AT_(DisplayDriver::LogLevel::ERROR, format, ##__VA_ARGS__)
+#else
+#define DRIVER_LOG_ERROR(msg) DRIVER_LOG_DISABLED_(msg)
+#define DRIVER_LOGF_ERROR(format, ...) DRIVER_LOGF_DISABLED_(format, ##__VA_ARGS__)
+#endif
+
+#if DRIVER_LOG_ACTIVE_LEVEL <= DRIVER_LOG_LEVEL_CRITICAL
+#define DRIVER_LOG_CRITICAL(msg) DRIVER_LOG_AT_(DisplayDriver::LogLevel::CRITICAL, msg)
+#define DRIVER_LOGF_CRITICAL(format, ...) DRIVER_LOGF_AT_(DisplayDriver::LogLevel::CRITICAL, format, ##__VA_ARGS__)
+#else
+#define DRIVER_LOG_CRITICAL(msg) DRIVER_LOG_DISABLED_(msg)
+#define DRIVER_LOGF_CRITICAL(format, ...) DRIVER_LOGF_DISABLED_(format, ##__VA_ARGS__)
+#endif
 
 } // namespace DisplayDriver
 
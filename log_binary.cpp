@@ -0,0 +1,251 @@
+#include "log_binary.h"
+#include "buffered_logger.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace DisplayDriver {
+
+namespace {
+
+constexpr char kHeaderMagic[8] = {'D', 'L', 'O', 'G', 'B', 'I', 'N', '1'};
+constexpr uint32_t kByteOrderMark = 0x01020304;
+constexpr size_t kMaxPayload = 1u << 30;  // Sanity limit when decoding
+
+template <typename T>
+inline char* put(char* p, T value) {
+    std::memcpy(p, &value, sizeof(value));
+    return p + sizeof(value);
+}
+
+template <typename T>
+inline const char* get(const char* p, T& value) {
+    std::memcpy(&value, p, sizeof(value));
+    return p + sizeof(value);
+}
+
+inline bool readExact(std::FILE* input, void* data, size_t size) {
+    return std::fread(data, 1, size, input) == size;
+}
+
+} // namespace
+
+void BinaryLogEncoder::startFile() {
+    m_headerPending = true;
+    m_threads.clear();
+    m_haveLastThread = false;
+    m_categories.clear();
+}
+
+void BinaryLogEncoder::setCalibration(const ClockCalibration& clock) {
+    m_source = clock.source();
+    m_ticksPerNs = clock.ticksPerNanosecond();
+    m_anchor = clock.latestAnchor();
+    m_calibrationPending = true;
+}
+
+void BinaryLogEncoder::appendEntry(std::string& out, const LogEntry& entry) {
+    if (m_headerPending) {
+        char header[sizeof(kHeaderMagic) + 8];
+        char* p = header;
+        std::memcpy(p, kHeaderMagic, sizeof(kHeaderMagic));
+        p += sizeof(kHeaderMagic);
+        p = put(p, kByteOrderMark);
+        put(p, static_cast<uint32_t>(m_source));
+        out.append(header, sizeof(header));
+        m_headerPending = false;
+        m_calibrationPending = true;  // Each file carries its own anchor
+    }
+    if (m_calibrationPending) {
+        char record[1 + 8 + 8 + 8 + 8];
+        char* p = record;
+        *p++ = 'C';
+        p = put(p, m_ticksPerNs);
+        p = put(p, m_anchor.ticks);
+        p = put(p, m_anchor.steadyNs);
+        put(p, m_anchor.wallNs);
+        out.append(record, sizeof(record));
+        m_calibrationPending = false;
+    }
+
+    const uint32_t thread = threadIndex(out, entry.threadId);
+    const uint32_t category = categoryIndex(out, entry.category);
+    const uint32_t length = static_cast<uint32_t>(entry.message.size());
+
+    char record[1 + 8 + 1 + 4 + 4 + 4 + 4];
+    char* p = record;
+    *p++ = 'E';
+    p = put(p, entry.ticks);
+    *p++ = static_cast<char>(entry.level);
+    p = put(p, thread);
+    p = put(p, category);
+    p = put(p, static_cast<uint32_t>(std::min<size_t>(entry.count, UINT32_MAX)));
+    put(p, length);
+    out.append(record, sizeof(record));
+    out.append(entry.message.data(), length);
+}
+
+uint32_t BinaryLogEncoder::threadIndex(std::string& out, std::thread::id id) {
+    if (m_haveLastThread && id == m_lastThread) {
+        return m_lastThreadIndex;
+    }
+    m_haveLastThread = true;
+    m_lastThread = id;
+
+    auto it = m_threads.find(id);
+    if (it != m_threads.end()) {
+        m_lastThreadIndex = it->second;
+        return it->second;
+    }
+
+    const uint32_t index = static_cast<uint32_t>(m_threads.size());
+    m_threads.emplace(id, index);
+    m_lastThreadIndex = index;
+
+    char record[1 + 4 + 1 + 32];
+    char* p = record;
+    *p++ = 'T';
+    p = put(p, index);
+    char* text = p + 1;
+    char* end = LogLineFormatter::writeThreadId(text, record + sizeof(record), id);
+    *p = static_cast<char>(end - text);
+    out.append(record, static_cast<size_t>(end - record));
+    return index;
+}
+
+uint32_t BinaryLogEncoder::categoryIndex(std::string& out, const LogCategory* category) {
+    if (!category) {
+        return 0;
+    }
+    auto it = m_categories.find(category);
+    if (it != m_categories.end()) {
+        return it->second;
+    }
+
+    const uint32_t index = static_cast<uint32_t>(m_categories.size() + 1);
+    m_categories.emplace(category, index);
+
+    const std::string& name = category->name();
+    const uint16_t length = static_cast<uint16_t>(std::min<size_t>(name.size(), UINT16_MAX));
+    char record[1 + 4 + 2];
+    char* p = record;
+    *p++ = 'N';
+    p = put(p, index);
+    put(p, length);
+    out.append(record, sizeof(record));
+    out.append(name.data(), length);
+    return index;
+}
+
+bool decodeBinaryLog(std::FILE* input, std::FILE* output) {
+    LogLineFormatter formatter;
+    std::string text;
+    std::string payload;
+    std::vector<std::string> threads;
+    std::vector<std::string> categories;
+
+    bool haveHeader = false;
+    bool haveCalibration = false;
+    ClockSource source = ClockSource::SteadyClock;
+    double ticksPerNs = 1.0;
+    ClockCalibration::Anchor anchor{};
+
+    auto flushText = [&] {
+        bool ok = std::fwrite(text.data(), 1, text.size(), output) == text.size();
+        text.clear();
+        return ok;
+    };
+
+    for (;;) {
+        const int tag = std::fgetc(input);
+        if (tag == EOF) {
+            return !std::ferror(input) && flushText();
+        }
+
+        if (tag == kHeaderMagic[0]) {
+            char rest[sizeof(kHeaderMagic) - 1 + 8];
+            if (!readExact(input, rest, sizeof(rest)) ||
+                std::memcmp(rest, kHeaderMagic + 1, sizeof(kHeaderMagic) - 1) != 0) {
+                break;
+            }
+            uint32_t byteOrder, clockSource;
+            get(get(rest + sizeof(kHeaderMagic) - 1, byteOrder), clockSource);
+            if (byteOrder != kByteOrderMark || clockSource > static_cast<uint32_t>(ClockSource::Tsc)) {
+                break;
+            }
+            source = static_cast<ClockSource>(clockSource);
+            threads.clear();
+            categories.assign(1, std::string());
+            haveHeader = true;
+            haveCalibration = false;
+            continue;
+        }
+        if (!haveHeader) {
+            break;
+        }
+
+        if (tag == 'C') {
+            char record[8 + 8 + 8 + 8];
+            if (!readExact(input, record, sizeof(record))) {
+                break;
+            }
+            get(get(get(get(record, ticksPerNs), anchor.ticks), anchor.steadyNs), anchor.wallNs);
+            haveCalibration = ticksPerNs > 0;
+        } else if (tag == 'T') {
+            char record[4 + 1];
+            if (!readExact(input, record, sizeof(record))) {
+                break;
+            }
+            uint32_t index;
+            get(record, index);
+            std::string name(static_cast<unsigned char>(record[4]), '\0');
+            if (index != threads.size() || !readExact(input, &name[0], name.size())) {
+                break;
+            }
+            threads.push_back(std::move(name));
+        } else if (tag == 'N') {
+            char record[4 + 2];
+            if (!readExact(input, record, sizeof(record))) {
+                break;
+            }
+            uint32_t index;
+            uint16_t length;
+            get(get(record, index), length);
+            std::string name(length, '\0');
+            if (index != categories.size() || !readExact(input, &name[0], name.size())) {
+                break;
+            }
+            categories.push_back(std::move(name));
+        } else if (tag == 'E') {
+            char record[8 + 1 + 4 + 4 + 4 + 4];
+            if (!readExact(input, record, sizeof(record))) {
+                break;
+            }
+            uint64_t ticks;
+            uint32_t thread, category, count, length;
+            const char* p = get(record, ticks);
+            const uint8_t level = static_cast<uint8_t>(*p++);
+            get(get(get(get(p, thread), category), count), length);
+            if (!haveCalibration || level > static_cast<uint8_t>(LogLevel::CRITICAL) || thread >= threads.size() ||
+                category >= categories.size() || length > kMaxPayload) {
+                break;
+            }
+            payload.resize(length);
+            if (!readExact(input, &payload[0], length)) {
+                break;
+            }
+            formatter.appendLine(text, static_cast<LogLevel>(level), threads[thread], categories[category], payload,
+                                 count, ClockCalibration::toWallClock(source, ticksPerNs, anchor, ticks));
+            if (text.size() >= 64 * 1024 && !flushText()) {
+                return false;
+            }
+        } else {
+            break;
+        }
+    }
+
+    flushText();
+    return false;
+}
+
+} // namespace DisplayDriver
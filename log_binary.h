@@ -0,0 +1,68 @@
+#ifndef LOG_BINARY_H
+#define LOG_BINARY_H
+
+#include "log_clock.h"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace DisplayDriver {
+
+struct LogEntry;
+class LogCategory;
+
+// Binary output: raw records instead of text lines, converted back to the
+// text format offline by log_decode. Every record starts with a tag byte;
+// integers are in host byte order, which the header records.
+//
+//   'D' "LOGBIN1" u32 byte-order mark, u32 clock source
+//                                   Header; starts every file and every
+//                                   session appended to one. Thread and
+//                                   category indices restart after it.
+//   'C' f64 ticks/ns, u64 ticks, i64 steady ns, i64 wall ns
+//                                   Calibration anchor, once per flush
+//   'T' u32 index, u8 length, text  Thread id as printed after "T:"
+//   'N' u32 index, u16 length, name Category name
+//   'E' u64 ticks, u8 level, u32 thread, u32 category (0 = none),
+//       u32 repeat count, u32 length, payload
+//                                   One log entry
+//
+// Records never span files, so every file decodes on its own.
+class BinaryLogEncoder {
+public:
+    // A new file: the next record is preceded by a header
+    void startFile();
+
+    // Anchor for the entries that follow; written lazily before the next entry
+    void setCalibration(const ClockCalibration& clock);
+
+    // Append `entry`, preceded by any header, calibration, thread or
+    // category definitions it depends on
+    void appendEntry(std::string& out, const LogEntry& entry);
+
+private:
+    uint32_t threadIndex(std::string& out, std::thread::id id);
+    uint32_t categoryIndex(std::string& out, const LogCategory* category);
+
+    bool m_headerPending = true;
+    bool m_calibrationPending = false;
+    ClockSource m_source = ClockSource::SteadyClock;
+    double m_ticksPerNs = 1.0;
+    ClockCalibration::Anchor m_anchor{};
+    std::unordered_map<std::thread::id, uint32_t> m_threads;
+    bool m_haveLastThread = false;  // Consecutive entries mostly share a thread
+    std::thread::id m_lastThread;
+    uint32_t m_lastThreadIndex = 0;
+    std::unordered_map<const LogCategory*, uint32_t> m_categories;
+};
+
+// Convert binary records from `input` into text lines on `output`, exactly
+// as the text output would have rendered them. False on a corrupt or
+// truncated record; everything before it has been written.
+bool decodeBinaryLog(std::FILE* input, std::FILE* output);
+
+} // namespace DisplayDriver
+
+#endif // LOG_BINARY_H
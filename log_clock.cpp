@@ -0,0 +1,139 @@
+#include "log_clock.h"
+
+#ifdef LOG_CLOCK_X86
+#include <cpuid.h>
+#endif
+
+namespace DisplayDriver {
+
+namespace {
+
+// Rates are only trusted once the baseline spans this much steady time
+constexpr int64_t kMinCalibrationNs = 10 * 1000 * 1000;
+
+int64_t steadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int64_t wallNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+#ifdef LOG_CLOCK_X86
+// One short spin per process so a fresh logger converts sensibly before its
+// first recalibration; later flushes refine the rate over longer baselines
+double initialTscRate() {
+    static const double rate = [] {
+        const int64_t steadyStart = steadyNowNs();
+        const uint64_t tscStart = __rdtsc();
+        int64_t steadyEnd;
+        do {
+            steadyEnd = steadyNowNs();
+        } while (steadyEnd - steadyStart < 2 * 1000 * 1000);
+        const uint64_t tscEnd = __rdtsc();
+        return static_cast<double>(tscEnd - tscStart) / static_cast<double>(steadyEnd - steadyStart);
+    }();
+    return rate;
+}
+#endif
+
+} // namespace
+
+const char* clockSourceName(ClockSource source) {
+    switch (source) {
+    case ClockSource::SteadyClock: return "steady_clock";
+    case ClockSource::MonotonicCoarse: return "monotonic_coarse";
+    case ClockSource::Tsc: return "tsc";
+    }
+    return "unknown";
+}
+
+bool tscSupported() {
+#ifdef LOG_CLOCK_X86
+    static const bool supported = [] {
+        unsigned int eax, ebx, ecx, edx;
+        if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) {
+            return false;
+        }
+        return (edx & (1u << 8)) != 0;  // Invariant TSC
+    }();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+ClockCalibration::ClockCalibration(ClockSource source)
+    : m_source(source == ClockSource::Tsc && !tscSupported() ? ClockSource::SteadyClock : source),
+      m_ticksPerNs(1.0) {
+#ifdef LOG_CLOCK_X86
+    if (m_source == ClockSource::Tsc) {
+        m_ticksPerNs = initialTscRate();
+    }
+#endif
+    m_base = sample();
+    m_latest = m_base;
+}
+
+ClockCalibration::Anchor ClockCalibration::sample() const {
+    Anchor anchor;
+    if (m_source != ClockSource::Tsc) {
+        // Both monotonic sources count CLOCK_MONOTONIC nanoseconds already
+        anchor.steadyNs = steadyNowNs();
+        anchor.wallNs = wallNowNs();
+        anchor.ticks = static_cast<uint64_t>(anchor.steadyNs);
+        return anchor;
+    }
+
+    // Bracket the clock reads and pair them with the midpoint tick
+    const uint64_t before = now();
+    anchor.steadyNs = steadyNowNs();
+    anchor.wallNs = wallNowNs();
+    const uint64_t after = now();
+    anchor.ticks = before + (after - before) / 2;
+    return anchor;
+}
+
+void ClockCalibration::recalibrate() {
+    Anchor latest = sample();
+
+    if (m_source == ClockSource::Tsc) {
+        const int64_t elapsedNs = latest.steadyNs - m_base.steadyNs;
+        if (elapsedNs >= kMinCalibrationNs) {
+            m_ticksPerNs = static_cast<double>(latest.ticks - m_base.ticks) / static_cast<double>(elapsedNs);
+        }
+    }
+    m_latest = latest;
+}
+
+uint64_t ClockCalibration::ticksFor(std::chrono::nanoseconds duration) const {
+    return static_cast<uint64_t>(static_cast<double>(duration.count()) * m_ticksPerNs);
+}
+
+int64_t ClockCalibration::offsetNs(ClockSource source, double ticksPerNs, const Anchor& anchor, uint64_t ticks) {
+    // Signed: entries captured before the anchor map to negative offsets
+    const int64_t deltaTicks = static_cast<int64_t>(ticks - anchor.ticks);
+    if (source != ClockSource::Tsc) {
+        return deltaTicks;
+    }
+    return static_cast<int64_t>(static_cast<double>(deltaTicks) / ticksPerNs);
+}
+
+std::chrono::steady_clock::time_point ClockCalibration::toSteady(uint64_t ticks) const {
+    return std::chrono::steady_clock::time_point(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::nanoseconds(m_latest.steadyNs + offsetNs(m_source, m_ticksPerNs, m_latest, ticks))));
+}
+
+std::chrono::system_clock::time_point ClockCalibration::toWallClock(uint64_t ticks) const {
+    return toWallClock(m_source, m_ticksPerNs, m_latest, ticks);
+}
+
+std::chrono::system_clock::time_point ClockCalibration::toWallClock(ClockSource source, double ticksPerNs,
+                                                                    const Anchor& anchor, uint64_t ticks) {
+    return std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+        std::chrono::nanoseconds(anchor.wallNs + offsetNs(source, ticksPerNs, anchor, ticks))));
+}
+
+} // namespace DisplayDriver
@@ -0,0 +1,89 @@
+#ifndef LOG_CLOCK_H
+#define LOG_CLOCK_H
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define LOG_CLOCK_X86 1
+#endif
+
+namespace DisplayDriver {
+
+// Timestamp source captured on the logging hot path. Producers store raw
+// ticks; the flush thread converts them to steady and wall time.
+enum class ClockSource {
+    SteadyClock,      // std::chrono::steady_clock (vDSO clock_gettime, ns)
+    MonotonicCoarse,  // CLOCK_MONOTONIC_COARSE: tick-resolution (1-4ms), cheapest syscall-free read
+    Tsc               // Raw rdtsc; needs an invariant TSC, else falls back to SteadyClock
+};
+
+const char* clockSourceName(ClockSource source);
+
+// True when the CPU advertises an invariant (constant-rate, always running) TSC
+bool tscSupported();
+
+// Maps ticks of one source onto steady_clock and system_clock. now() is safe
+// from any thread; recalibrate() and the conversions belong to the single
+// consumer (the flush path), which refreshes the TSC rate against
+// steady_clock over an ever longer baseline.
+class ClockCalibration {
+public:
+    // Matching readings of the tick source and both std clocks
+    struct Anchor {
+        uint64_t ticks;
+        int64_t steadyNs;
+        int64_t wallNs;
+    };
+
+    explicit ClockCalibration(ClockSource source);
+
+    ClockSource source() const { return m_source; }
+
+    uint64_t now() const {
+        switch (m_source) {
+#ifdef LOG_CLOCK_X86
+        case ClockSource::Tsc:
+            return __rdtsc();
+#endif
+        case ClockSource::MonotonicCoarse: {
+            timespec ts;
+            clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+            return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+        }
+        default:
+            return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+        }
+    }
+
+    // Take a fresh (ticks, steady, wall) anchor and refine the tick rate
+    void recalibrate();
+
+    double ticksPerNanosecond() const { return m_ticksPerNs; }
+    uint64_t ticksFor(std::chrono::nanoseconds duration) const;
+
+    std::chrono::steady_clock::time_point toSteady(uint64_t ticks) const;
+    std::chrono::system_clock::time_point toWallClock(uint64_t ticks) const;
+
+    // The anchor conversions currently extrapolate from
+    const Anchor& latestAnchor() const { return m_latest; }
+
+    // toWallClock() for a recorded calibration (e.g. a binary log header)
+    static std::chrono::system_clock::time_point toWallClock(ClockSource source, double ticksPerNs,
+                                                             const Anchor& anchor, uint64_t ticks);
+
+private:
+    Anchor sample() const;
+    static int64_t offsetNs(ClockSource source, double ticksPerNs, const Anchor& anchor, uint64_t ticks);
+
+    ClockSource m_source;
+    Anchor m_base;     // First sample; the rate is measured from here
+    Anchor m_latest;   // Conversions extrapolate from the newest sample
+    double m_ticksPerNs;
+};
+
+} // namespace DisplayDriver
+
+#endif // LOG_CLOCK_H
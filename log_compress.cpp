@@ -0,0 +1,285 @@
+#include "log_compress.h"
+#include <algorithm>
+#include <cstring>
+
+namespace DisplayDriver {
+
+namespace {
+
+constexpr int kHashBits = 14;
+constexpr size_t kMinMatch = 4;
+constexpr size_t kMaxOffset = 65535;
+constexpr size_t kMaxFrameSize = 1u << 30;  // Sanity limit when reading frames
+constexpr char kFrameMagic[4] = {'D', 'L', 'Z', '1'};
+
+inline uint32_t load32(const uint8_t* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint64_t load64(const uint8_t* p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint32_t hashPosition(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - kHashBits);
+}
+
+inline void putLength(uint8_t*& op, size_t length) {
+    for (; length >= 255; length -= 255) {
+        *op++ = 255;
+    }
+    *op++ = static_cast<uint8_t>(length);
+}
+
+inline void putLittleEndian32(char* out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = static_cast<char>(value >> (8 * i));
+    }
+}
+
+inline uint32_t getLittleEndian32(const unsigned char* in) {
+    return in[0] | (in[1] << 8) | (in[2] << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+// Length of the common run at `a` and `b`, without reading past `end`
+inline size_t matchLength(const uint8_t* a, const uint8_t* b, const uint8_t* end) {
+    const uint8_t* start = a;
+    while (a + 8 <= end) {
+        uint64_t diff = load64(a) ^ load64(b);
+        if (diff != 0) {
+            return static_cast<size_t>(a - start) + (__builtin_ctzll(diff) >> 3);
+        }
+        a += 8;
+        b += 8;
+    }
+    while (a < end && *a == *b) {
+        a++;
+        b++;
+    }
+    return static_cast<size_t>(a - start);
+}
+
+// Literal run, optionally followed by a match (`matchLen` 0 ends the block)
+inline void putSequence(uint8_t*& op, const uint8_t* literals, size_t literalLen, size_t offset, size_t matchLen) {
+    uint8_t* token = op++;
+    *token = static_cast<uint8_t>((literalLen < 15 ? literalLen : 15) << 4);
+    if (literalLen >= 15) {
+        putLength(op, literalLen - 15);
+    }
+    std::memcpy(op, literals, literalLen);
+    op += literalLen;
+    if (matchLen == 0) {
+        return;
+    }
+    *op++ = static_cast<uint8_t>(offset);
+    *op++ = static_cast<uint8_t>(offset >> 8);
+    const size_t code = matchLen - kMinMatch;
+    *token |= static_cast<uint8_t>(code < 15 ? code : 15);
+    if (code >= 15) {
+        putLength(op, code - 15);
+    }
+}
+
+inline bool readLength(const uint8_t*& ip, const uint8_t* end, size_t& length) {
+    uint8_t byte;
+    do {
+        if (ip >= end) {
+            return false;
+        }
+        byte = *ip++;
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+} // namespace
+
+LzCompressor::LzCompressor() : m_table(size_t(1) << kHashBits) {}
+
+size_t LzCompressor::compress(const char* data, size_t size, char* out) {
+    const uint8_t* const base = reinterpret_cast<const uint8_t*>(data);
+    const uint8_t* const end = base + size;
+    const uint8_t* ip = base;
+    const uint8_t* anchor = base;
+    uint8_t* op = reinterpret_cast<uint8_t*>(out);
+
+    // Positions are relative to this block, so the table restarts each time
+    std::fill(m_table.begin(), m_table.end(), 0);
+
+    if (size >= kMinMatch + 8) {
+        const uint8_t* const matchLimit = end - kMinMatch;
+        while (ip <= matchLimit) {
+            const uint32_t sequence = load32(ip);
+            uint32_t& slot = m_table[hashPosition(sequence)];
+            const uint8_t* ref = base + slot;
+            slot = static_cast<uint32_t>(ip - base);
+
+            if (ref >= ip || static_cast<size_t>(ip - ref) > kMaxOffset || load32(ref) != sequence) {
+                // Step faster through input that keeps missing
+                ip += 1 + (static_cast<size_t>(ip - anchor) >> 6);
+                continue;
+            }
+
+            while (ip > anchor && ref > base && ip[-1] == ref[-1]) {
+                ip--;
+                ref--;
+            }
+            const size_t length = kMinMatch + matchLength(ip + kMinMatch, ref + kMinMatch, end);
+            putSequence(op, anchor, static_cast<size_t>(ip - anchor), static_cast<size_t>(ip - ref), length);
+            ip += length;
+            anchor = ip;
+
+            // Seed the table inside the match so the next repeat is found
+            if (ip <= matchLimit) {
+                m_table[hashPosition(load32(ip - 2))] = static_cast<uint32_t>(ip - 2 - base);
+            }
+        }
+    }
+
+    putSequence(op, anchor, static_cast<size_t>(end - anchor), 0, 0);
+    return static_cast<size_t>(op - reinterpret_cast<uint8_t*>(out));
+}
+
+bool lzDecompress(const char* data, size_t size, char* out, size_t outSize) {
+    const uint8_t* ip = reinterpret_cast<const uint8_t*>(data);
+    const uint8_t* const end = ip + size;
+    uint8_t* const outBase = reinterpret_cast<uint8_t*>(out);
+    uint8_t* op = outBase;
+    uint8_t* const outEnd = op + outSize;
+
+    while (ip < end) {
+        const uint8_t token = *ip++;
+
+        size_t literalLen = token >> 4;
+        if (literalLen == 15 && !readLength(ip, end, literalLen)) {
+            return false;
+        }
+        if (literalLen > static_cast<size_t>(end - ip) || literalLen > static_cast<size_t>(outEnd - op)) {
+            return false;
+        }
+        std::memcpy(op, ip, literalLen);
+        ip += literalLen;
+        op += literalLen;
+        if (ip == end) {
+            break;  // Final literals
+        }
+
+        if (end - ip < 2) {
+            return false;
+        }
+        const size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        size_t matchLen = token & 15;
+        if (matchLen == 15 && !readLength(ip, end, matchLen)) {
+            return false;
+        }
+        matchLen += kMinMatch;
+        if (offset == 0 || offset > static_cast<size_t>(op - outBase) ||
+            matchLen > static_cast<size_t>(outEnd - op)) {
+            return false;
+        }
+
+        const uint8_t* ref = op - offset;
+        if (offset >= matchLen) {
+            std::memcpy(op, ref, matchLen);
+            op += matchLen;
+        } else {
+            // Overlapping copy repeats the last `offset` bytes
+            for (size_t i = 0; i < matchLen; i++) {
+                *op++ = *ref++;
+            }
+        }
+    }
+    return op == outEnd;
+}
+
+void appendLzFrame(std::string& out, const char* data, size_t size, LzCompressor& compressor) {
+    const size_t start = out.size();
+    out.resize(start + kLzFrameHeaderSize + LzCompressor::bound(size));
+    char* header = &out[start];
+    size_t stored = compressor.compress(data, size, header + kLzFrameHeaderSize);
+    if (stored >= size) {
+        std::memcpy(header + kLzFrameHeaderSize, data, size);
+        stored = size;
+    }
+    std::memcpy(header, kFrameMagic, sizeof(kFrameMagic));
+    putLittleEndian32(header + 4, static_cast<uint32_t>(size));
+    putLittleEndian32(header + 8, static_cast<uint32_t>(stored));
+    out.resize(start + kLzFrameHeaderSize + stored);
+}
+
+bool decompressLzFrames(std::FILE* input, std::FILE* output) {
+    std::vector<char> stored;
+    std::vector<char> raw;
+    for (;;) {
+        unsigned char header[kLzFrameHeaderSize];
+        const size_t got = std::fread(header, 1, sizeof(header), input);
+        if (got == 0) {
+            return !std::ferror(input);
+        }
+        if (got != sizeof(header) || std::memcmp(header, kFrameMagic, sizeof(kFrameMagic)) != 0) {
+            return false;
+        }
+        const uint32_t rawSize = getLittleEndian32(header + 4);
+        const uint32_t storedSize = getLittleEndian32(header + 8);
+        if (rawSize > kMaxFrameSize || storedSize > LzCompressor::bound(rawSize)) {
+            return false;
+        }
+
+        stored.resize(storedSize);
+        if (std::fread(stored.data(), 1, storedSize, input) != storedSize) {
+            return false;
+        }
+        const char* block = stored.data();
+        if (storedSize != rawSize) {
+            raw.resize(rawSize);
+            if (!lzDecompress(stored.data(), storedSize, raw.data(), rawSize)) {
+                return false;
+            }
+            block = raw.data();
+        }
+        if (std::fwrite(block, 1, rawSize, output) != rawSize) {
+            return false;
+        }
+    }
+}
+
+CompressingSink::CompressingSink(std::unique_ptr<LogSink> inner)
+    : m_inner(std::move(inner)), m_name(std::string("lz+") + m_inner->name()) {}
+
+void CompressingSink::write(const std::string_view* blocks, size_t count) {
+    if (m_frames.size() < count) {
+        m_frames.resize(count);
+    }
+    m_views.clear();
+    for (size_t i = 0; i < count; i++) {
+        m_frames[i].clear();
+        appendLzFrame(m_frames[i], blocks[i].data(), blocks[i].size(), m_compressor);
+        m_views.emplace_back(m_frames[i]);
+        m_inputBytes += blocks[i].size();
+    }
+    m_inner->write(m_views.data(), m_views.size());
+    syncCounters();
+}
+
+void CompressingSink::flush() {
+    m_inner->flush();
+    syncCounters();
+}
+
+void CompressingSink::close() {
+    m_inner->close();
+    syncCounters();
+}
+
+void CompressingSink::syncCounters() {
+    m_syscalls = m_inner->syscallCount();
+    m_bytesWritten = m_inner->bytesWritten();
+    m_bytesAppended = m_inner->bytesAppended();
+}
+
+} // namespace DisplayDriver
@@ -0,0 +1,83 @@
+#ifndef LOG_COMPRESS_H
+#define LOG_COMPRESS_H
+
+#include "log_sink.h"
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace DisplayDriver {
+
+// Byte-oriented LZ77 block codec in the LZ4 family: greedy hash-chain-free
+// matching with a 64 KiB window. Every block is independent, so a damaged
+// block never affects its neighbours.
+//
+// Block layout, repeated until the input is consumed:
+//   token      high nibble literal length, low nibble match length - 4
+//              (15 means "more follows" as 255-continued bytes)
+//   literals
+//   offset     2 bytes little-endian, absent after the final literals
+//   match length continuation bytes
+class LzCompressor {
+public:
+    LzCompressor();
+
+    // Worst-case compressed size of `size` input bytes
+    static size_t bound(size_t size) { return size + size / 255 + 16; }
+
+    // Compress into `out`, which must hold bound(size) bytes; returns the
+    // compressed size
+    size_t compress(const char* data, size_t size, char* out);
+
+private:
+    std::vector<uint32_t> m_table;  // Hash of 4 bytes -> last position
+};
+
+// Decode one block into exactly `outSize` bytes; false on malformed input
+bool lzDecompress(const char* data, size_t size, char* out, size_t outSize);
+
+// Framed stream: each frame is a 12-byte little-endian header
+//   magic "DLZ1" | raw size | stored size
+// followed by the stored bytes. A stored size equal to the raw size means
+// the block did not compress and is kept verbatim. Frames from separate
+// runs can simply be concatenated.
+constexpr size_t kLzFrameHeaderSize = 12;
+
+// Append one frame holding `size` bytes of `data`
+void appendLzFrame(std::string& out, const char* data, size_t size, LzCompressor& compressor);
+
+// Decode concatenated frames from `input` to `output`; false on a corrupt
+// or truncated frame (everything before it has been written)
+bool decompressLzFrames(std::FILE* input, std::FILE* output);
+
+// Compresses every block into a frame before passing it on, so the file
+// holds framed blocks instead of text. bytesAppended() counts compressed
+// bytes on disk; inputBytes() the text that went in.
+class CompressingSink : public LogSink {
+public:
+    explicit CompressingSink(std::unique_ptr<LogSink> inner);
+
+    bool isOpen() const override { return m_inner->isOpen(); }
+    const char* name() const override { return m_name.c_str(); }
+    void write(const std::string_view* blocks, size_t count) override;
+    void flush() override;
+    void close() override;
+
+    size_t inputBytes() const { return m_inputBytes; }
+
+private:
+    void syncCounters();
+
+    std::unique_ptr<LogSink> m_inner;
+    std::string m_name;
+    LzCompressor m_compressor;
+    std::vector<std::string> m_frames;  // Reused per write
+    std::vector<std::string_view> m_views;
+    size_t m_inputBytes = 0;
+};
+
+} // namespace DisplayDriver
+
+#endif // LOG_COMPRESS_H
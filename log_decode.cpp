@@ -0,0 +1,36 @@
+// Converts log files written with OutputFormat::Binary to the text format.
+//
+//   log_decode driver.log > driver.txt
+//   log_decompress driver.log | log_decode      (binary + compressOutput)
+#include "log_binary.h"
+#include <cstdio>
+#include <cstring>
+
+int main(int argc, char** argv) {
+    if (argc > 1 && (std::strcmp(argv[1], "-h") == 0 || std::strcmp(argv[1], "--help") == 0)) {
+        std::fprintf(stderr, "usage: %s [file...]\n", argv[0]);
+        return 0;
+    }
+
+    int status = 0;
+    if (argc == 1) {
+        if (!DisplayDriver::decodeBinaryLog(stdin, stdout)) {
+            std::fprintf(stderr, "%s: corrupt or truncated input\n", argv[0]);
+            status = 1;
+        }
+    }
+    for (int i = 1; i < argc; i++) {
+        std::FILE* input = std::fopen(argv[i], "rb");
+        if (!input) {
+            std::perror(argv[i]);
+            status = 1;
+            continue;
+        }
+        if (!DisplayDriver::decodeBinaryLog(input, stdout)) {
+            std::fprintf(stderr, "%s: %s: corrupt or truncated input\n", argv[0], argv[i]);
+            status = 1;
+        }
+        std::fclose(input);
+    }
+    return status;
+}
@@ -0,0 +1,273 @@
+#include "log_flight_recorder.h"
+#include "buffered_logger.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace DisplayDriver {
+
+namespace {
+
+constexpr char kMagic[8] = {'D', 'L', 'F', 'L', 'I', 'G', 'H', 'T'};
+constexpr uint32_t kVersion = 2;
+constexpr uint8_t kDeferred = 1;      // Text is a format; `argsLength` argument bytes follow it
+constexpr uint8_t kArgumentsCut = 2;  // Deferred, but the arguments did not fit
+
+struct Calibration {
+    double ticksPerNs;
+    ClockCalibration::Anchor anchor;
+};
+
+// Plain view of FlightRecorder::Header, for reading files no one writes
+struct HeaderView {
+    char magic[8];
+    uint32_t version;
+    uint32_t slotSize;
+    uint64_t slotCount;
+    uint64_t generation;
+    uint32_t clockSource;
+    uint32_t calibrationIndex;
+    Calibration calibration[2];
+    alignas(64) uint64_t cursor;
+};
+
+uint64_t threadValue(std::thread::id id) {
+    if constexpr (sizeof(std::thread::id) == sizeof(uint64_t)) {
+        uint64_t value;
+        std::memcpy(&value, &id, sizeof(value));
+        return value;
+    } else {
+        return std::hash<std::thread::id>()(id);
+    }
+}
+
+// Entry text is short; constant-size moves beat the rep movs a
+// variable-length memcpy expands to here
+inline void copyShort(char* out, const char* in, size_t length) {
+    for (; length >= 16; length -= 16, out += 16, in += 16) {
+        std::memcpy(out, in, 16);
+    }
+    if (length >= 8) {
+        std::memcpy(out, in, 8);
+        std::memcpy(out + length - 8, in + length - 8, 8);
+    } else if (length >= 4) {
+        std::memcpy(out, in, 4);
+        std::memcpy(out + length - 4, in + length - 4, 4);
+    } else {
+        for (size_t i = 0; i < length; i++) {
+            out[i] = in[i];
+        }
+    }
+}
+
+// Rendered deferred entries are cut here; a slot's format and arguments
+// rarely expand past a few hundred bytes
+constexpr size_t kMaxRenderedLength = 4096;
+
+size_t roundUpPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+} // namespace
+
+struct FlightRecorder::Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t slotSize;
+    uint64_t slotCount;
+    uint64_t generation;                   // Bumped each time a process opens the file
+    uint32_t clockSource;
+    std::atomic<uint32_t> calibrationIndex;  // Which of the two anchors is current
+    Calibration calibration[2];
+    alignas(64) std::atomic<uint64_t> cursor;  // Next ring index to claim
+};
+
+struct FlightRecorder::Slot {
+    std::atomic<uint64_t> sequence;  // Ring index + 1 once complete, 0 while written
+    uint64_t ticks;
+    uint64_t thread;
+    uint8_t level;
+    uint8_t flags;
+    uint8_t categoryLength;
+    uint8_t argsLength;
+    uint16_t textLength;
+    char data[kSlotSize - 30];  // Category name, text, then any arguments
+};
+
+FlightRecorder::FlightRecorder(const std::string& path, size_t slots, ClockSource source) {
+    static_assert(sizeof(Slot) == kSlotSize, "slot layout");
+    static_assert(sizeof(Slot::data) <= UINT8_MAX, "argsLength must hold any argument bytes that fit");
+    static_assert(sizeof(Header) <= kHeaderSize && sizeof(Header) == sizeof(HeaderView), "header layout");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "ring cursor must be lock-free in shared memory");
+
+    // Keep the previous recording (typically from the process that crashed)
+    uint64_t generation = 1;
+    int previous = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (previous >= 0) {
+        HeaderView old;
+        if (::pread(previous, &old, sizeof(old), 0) == static_cast<ssize_t>(sizeof(old)) &&
+            std::memcmp(old.magic, kMagic, sizeof(kMagic)) == 0) {
+            generation = old.generation + 1;
+        }
+        ::close(previous);
+        std::rename(path.c_str(), (path + ".prev").c_str());
+    }
+
+    const size_t slotCount = roundUpPowerOfTwo(std::max<size_t>(slots, 16));
+    const size_t bytes = kHeaderSize + slotCount * kSlotSize;
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0 || ::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        std::cerr << "Failed to create flight recorder: " << path << std::endl;
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return;
+    }
+    void* map = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);  // The mapping keeps the file alive
+    if (map == MAP_FAILED) {
+        std::cerr << "Failed to map flight recorder: " << path << std::endl;
+        return;
+    }
+
+    // The file is fresh (zero-filled), so only the header needs setting up
+    m_header = new (map) Header();
+    std::memcpy(m_header->magic, kMagic, sizeof(kMagic));
+    m_header->version = kVersion;
+    m_header->slotSize = kSlotSize;
+    m_header->slotCount = slotCount;
+    m_header->generation = generation;
+    m_header->clockSource = static_cast<uint32_t>(source);
+    m_slots = reinterpret_cast<Slot*>(static_cast<char*>(map) + kHeaderSize);
+    m_mask = slotCount - 1;
+    m_mappedBytes = bytes;
+}
+
+FlightRecorder::~FlightRecorder() {
+    if (m_header) {
+        ::munmap(m_header, m_mappedBytes);  // Contents stay in the file
+    }
+}
+
+void FlightRecorder::record(uint64_t ticks, int level, std::thread::id thread, std::string_view category,
+                            std::string_view text, bool deferred, std::string_view args) {
+    const uint64_t index = m_header->cursor.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = m_slots[index & m_mask];
+
+    // Invalidate before overwriting; the compiler must not sink this store
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+
+    const size_t categoryLength = std::min<size_t>(category.size(), 64);
+    const size_t textLength = std::min(text.size(), sizeof(slot.data) - categoryLength);
+    const bool argsFit = args.size() <= sizeof(slot.data) - categoryLength - textLength;
+    slot.ticks = ticks;
+    slot.thread = threadValue(thread);
+    slot.level = static_cast<uint8_t>(level);
+    slot.flags = !deferred ? 0 : argsFit ? kDeferred : kDeferred | kArgumentsCut;
+    slot.categoryLength = static_cast<uint8_t>(categoryLength);
+    slot.argsLength = static_cast<uint8_t>(deferred && argsFit ? args.size() : 0);
+    slot.textLength = static_cast<uint16_t>(textLength);
+    copyShort(slot.data, category.data(), categoryLength);
+    copyShort(slot.data + categoryLength, text.data(), textLength);
+    copyShort(slot.data + categoryLength + textLength, args.data(), slot.argsLength);
+
+    slot.sequence.store(index + 1, std::memory_order_release);
+}
+
+void FlightRecorder::updateCalibration(const ClockCalibration& clock) {
+    const uint32_t next = 1 - m_header->calibrationIndex.load(std::memory_order_relaxed);
+    m_header->calibration[next].ticksPerNs = clock.ticksPerNanosecond();
+    m_header->calibration[next].anchor = clock.latestAnchor();
+    m_header->calibrationIndex.store(next, std::memory_order_release);
+}
+
+uint64_t FlightRecorder::generation() const {
+    return m_header ? m_header->generation : 0;
+}
+
+bool dumpFlightRecorder(const std::string& path, size_t maxEntries, std::FILE* output) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    void* map = MAP_FAILED;
+    if (::fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= FlightRecorder::kHeaderSize) {
+        map = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+    const size_t fileSize = static_cast<size_t>(st.st_size);
+
+    const auto* header = static_cast<const HeaderView*>(map);
+    const uint64_t slotCount = header->slotCount;
+    const bool valid = std::memcmp(header->magic, kMagic, sizeof(kMagic)) == 0 && header->version == kVersion &&
+                       header->slotSize == FlightRecorder::kSlotSize && slotCount > 0 &&
+                       (slotCount & (slotCount - 1)) == 0 &&
+                       slotCount <= (fileSize - FlightRecorder::kHeaderSize) / FlightRecorder::kSlotSize &&
+                       header->clockSource <= static_cast<uint32_t>(ClockSource::Tsc) &&
+                       header->calibrationIndex <= 1 &&
+                       header->calibration[header->calibrationIndex].ticksPerNs > 0;
+    if (!valid) {
+        ::munmap(map, fileSize);
+        return false;
+    }
+
+    const auto source = static_cast<ClockSource>(header->clockSource);
+    const Calibration& calibration = header->calibration[header->calibrationIndex];
+    const auto* slots = reinterpret_cast<const FlightRecorder::Slot*>(
+        static_cast<const char*>(map) + FlightRecorder::kHeaderSize);
+
+    const uint64_t cursor = header->cursor;
+    const uint64_t count = std::min<uint64_t>({cursor, slotCount, maxEntries});
+
+    LogLineFormatter formatter;
+    std::string text;
+    std::string message;
+    for (uint64_t index = cursor - count; index < cursor; index++) {
+        const auto& slot = slots[index & (slotCount - 1)];
+        // Skips slots that were mid-write, or already reused by a later lap
+        if (slot.sequence.load(std::memory_order_acquire) != index + 1 ||
+            slot.level > static_cast<uint8_t>(LogLevel::CRITICAL) ||
+            size_t{slot.categoryLength} + slot.textLength + slot.argsLength > sizeof(slot.data)) {
+            continue;
+        }
+
+        char threadId[24];
+        char* threadIdEnd = std::to_chars(threadId, threadId + sizeof(threadId), slot.thread, 16).ptr;
+        const std::string_view stored(slot.data + slot.categoryLength, slot.textLength);
+        if (slot.flags & kArgumentsCut) {
+            message.assign(stored).append(" [arguments not recorded]");
+        } else if (slot.flags & kDeferred) {
+            message.resize(kMaxRenderedLength);
+            char* end = detail::renderDeferred(&message[0], &message[0] + message.size(), stored,
+                                               std::string_view(stored.data() + stored.size(), slot.argsLength));
+            message.resize(static_cast<size_t>(end - message.data()));
+        } else {
+            message.assign(stored);
+        }
+        formatter.appendLine(text, static_cast<LogLevel>(slot.level),
+                             std::string_view(threadId, static_cast<size_t>(threadIdEnd - threadId)),
+                             std::string_view(slot.data, slot.categoryLength), message, 1,
+                             ClockCalibration::toWallClock(source, calibration.ticksPerNs, calibration.anchor,
+                                                           slot.ticks));
+    }
+
+    ::munmap(map, fileSize);
+    return std::fwrite(text.data(), 1, text.size(), output) == text.size();
+}
+
+} // namespace DisplayDriver
@@ -0,0 +1,70 @@
+#ifndef LOG_FLIGHT_RECORDER_H
+#define LOG_FLIGHT_RECORDER_H
+
+#include "log_clock.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace DisplayDriver {
+
+// Crash-persistent copy of the most recent entries: a fixed-slot ring in a
+// MAP_SHARED file mapping. Producers copy each entry into the next slot with
+// plain stores, so the kernel still holds the data in the page cache if the
+// process dies; log_recover extracts it afterwards. (It does not survive a
+// kernel crash or power loss: nothing is ever msync'ed.)
+//
+// Layout: one 4 KiB header page, then `slots` 256-byte slots. A slot is
+// valid when its sequence equals its ring index + 1; a writer zeroes the
+// sequence first and publishes it last, so a half-written slot is skipped.
+class FlightRecorder {
+public:
+    static constexpr size_t kSlotSize = 256;
+    static constexpr size_t kHeaderSize = 4096;
+
+    // Maps `path` with room for `slots` entries (rounded up to a power of
+    // two). A previous recording is kept as "<path>.prev" first, so a
+    // restarted process does not overwrite the one that crashed.
+    FlightRecorder(const std::string& path, size_t slots, ClockSource source);
+    ~FlightRecorder();
+
+    FlightRecorder(const FlightRecorder&) = delete;
+    FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+    bool isOpen() const { return m_header != nullptr; }
+
+    // Producer hot path: memory stores only. Text longer than a slot is cut.
+    // A `deferred` entry's text is its printf format and `args` the
+    // serialized arguments, stored after it when both fit; recovery renders
+    // them (see detail::renderDeferred).
+    void record(uint64_t ticks, int level, std::thread::id thread, std::string_view category,
+                std::string_view text, bool deferred = false, std::string_view args = std::string_view());
+
+    // Flush thread: store the anchor recovery uses to print wall times
+    void updateCalibration(const ClockCalibration& clock);
+
+    uint64_t generation() const;
+
+private:
+    friend bool dumpFlightRecorder(const std::string& path, size_t maxEntries, std::FILE* output);
+
+    struct Header;
+    struct Slot;
+
+    Header* m_header = nullptr;
+    Slot* m_slots = nullptr;
+    size_t m_mask = 0;
+    size_t m_mappedBytes = 0;
+};
+
+// Write up to the last `maxEntries` recorded entries from a recorder file
+// to `output` in the text log format, oldest first. False if the file is
+// missing or not a flight recorder.
+bool dumpFlightRecorder(const std::string& path, size_t maxEntries, std::FILE* output);
+
+} // namespace DisplayDriver
+
+#endif // LOG_FLIGHT_RECORDER_H
@@ -0,0 +1,248 @@
+#include "log_hash.h"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define LOG_HASH_X86 1
+#endif
+
+namespace DisplayDriver {
+
+namespace {
+
+constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t kPrime3 = 0x165667B19E3779F9ull;
+constexpr uint64_t kPrime4 = 0x85EBCA77C2B2AE63ull;
+constexpr uint64_t kPrime32 = 0x9E3779B1ull;
+
+constexpr size_t kStripeSize = 32;
+constexpr size_t kStripesPerScramble = 16;
+
+alignas(32) constexpr uint64_t kStripeKey[4] = {
+    0xBE4BA423396CFEB8ull, 0x1CAD21F72C81017Cull, 0xDB979083E96DD4DEull, 0x1F67B3B7A4A44072ull
+};
+alignas(32) constexpr uint64_t kScrambleKey[4] = {
+    0x78E5C0CC4EE679CBull, 0x2172FFCC7DD05A82ull, 0x8E2443F7744608B8ull, 0x4C263A81E69035E0ull
+};
+constexpr uint64_t kMergeKey[4] = {
+    0xCB00C391BB52283Cull, 0xA32E531B8B65D088ull, 0x4EF90DA297486471ull, 0xD8ACDEA946EF1938ull
+};
+
+using AccumulateFn = void (*)(uint64_t* acc, const unsigned char* data, size_t stripes);
+
+uint64_t read64(const unsigned char* p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+// Folded 64x64->128 multiply
+uint64_t mix(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t product = static_cast<__uint128_t>(a) * b;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#else
+    uint64_t aLo = a & 0xFFFFFFFFull, aHi = a >> 32;
+    uint64_t bLo = b & 0xFFFFFFFFull, bHi = b >> 32;
+    uint64_t loLo = aLo * bLo, hiLo = aHi * bLo, loHi = aLo * bHi, hiHi = aHi * bHi;
+    uint64_t cross = (loLo >> 32) + (hiLo & 0xFFFFFFFFull) + loHi;
+    uint64_t upper = hiHi + (hiLo >> 32) + (cross >> 32);
+    uint64_t lower = (cross << 32) | (loLo & 0xFFFFFFFFull);
+    return lower ^ upper;
+#endif
+}
+
+uint64_t avalanche(uint64_t h) {
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    h *= kPrime3;
+    h ^= h >> 32;
+    return h;
+}
+
+// Per stripe and lane: acc[i] += lo32(w ^ key) * hi32(w ^ key); acc[i ^ 1] += w.
+// Every 16 stripes: acc = (acc ^ acc >> 47 ^ key) * prime32.
+void accumulateScalar(uint64_t* acc, const unsigned char* data, size_t stripes) {
+    for (size_t s = 0; s < stripes; ++s) {
+        const unsigned char* stripe = data + s * kStripeSize;
+        for (size_t lane = 0; lane < 4; ++lane) {
+            uint64_t word = read64(stripe + lane * 8);
+            uint64_t keyed = word ^ kStripeKey[lane];
+            acc[lane ^ 1] += word;
+            acc[lane] += (keyed & 0xFFFFFFFFull) * (keyed >> 32);
+        }
+
+        if ((s + 1) % kStripesPerScramble == 0) {
+            for (size_t lane = 0; lane < 4; ++lane) {
+                uint64_t a = acc[lane];
+                a ^= a >> 47;
+                a ^= kScrambleKey[lane];
+                acc[lane] = a * kPrime32;
+            }
+        }
+    }
+}
+
+#ifdef LOG_HASH_X86
+
+__attribute__((target("sse2")))
+void accumulateSse2(uint64_t* acc, const unsigned char* data, size_t stripes) {
+    __m128i acc01 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc));
+    __m128i acc23 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + 2));
+    const __m128i key01 = _mm_load_si128(reinterpret_cast<const __m128i*>(kStripeKey));
+    const __m128i key23 = _mm_load_si128(reinterpret_cast<const __m128i*>(kStripeKey + 2));
+    const __m128i scramble01 = _mm_load_si128(reinterpret_cast<const __m128i*>(kScrambleKey));
+    const __m128i scramble23 = _mm_load_si128(reinterpret_cast<const __m128i*>(kScrambleKey + 2));
+    const __m128i prime = _mm_set1_epi64x(static_cast<long long>(kPrime32));
+
+    auto lanes = [](__m128i accumulator, __m128i words, __m128i key) {
+        __m128i keyed = _mm_xor_si128(words, key);
+        __m128i keyedHi = _mm_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1));
+        __m128i product = _mm_mul_epu32(keyed, keyedHi);
+        __m128i swapped = _mm_shuffle_epi32(words, _MM_SHUFFLE(1, 0, 3, 2));
+        return _mm_add_epi64(_mm_add_epi64(accumulator, product), swapped);
+    };
+    auto scramble = [prime](__m128i accumulator, __m128i key) {
+        accumulator = _mm_xor_si128(accumulator, _mm_srli_epi64(accumulator, 47));
+        accumulator = _mm_xor_si128(accumulator, key);
+        __m128i lo = _mm_mul_epu32(accumulator, prime);
+        __m128i hi = _mm_mul_epu32(_mm_srli_epi64(accumulator, 32), prime);
+        return _mm_add_epi64(lo, _mm_slli_epi64(hi, 32));
+    };
+
+    for (size_t s = 0; s < stripes; ++s) {
+        const unsigned char* stripe = data + s * kStripeSize;
+        acc01 = lanes(acc01, _mm_loadu_si128(reinterpret_cast<const __m128i*>(stripe)), key01);
+        acc23 = lanes(acc23, _mm_loadu_si128(reinterpret_cast<const __m128i*>(stripe + 16)), key23);
+
+        if ((s + 1) % kStripesPerScramble == 0) {
+            acc01 = scramble(acc01, scramble01);
+            acc23 = scramble(acc23, scramble23);
+        }
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(acc), acc01);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(acc + 2), acc23);
+}
+
+__attribute__((target("avx2")))
+void accumulateAvx2(uint64_t* acc, const unsigned char* data, size_t stripes) {
+    __m256i accumulator = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc));
+    const __m256i key = _mm256_load_si256(reinterpret_cast<const __m256i*>(kStripeKey));
+    const __m256i scrambleKey = _mm256_load_si256(reinterpret_cast<const __m256i*>(kScrambleKey));
+    const __m256i prime = _mm256_set1_epi64x(static_cast<long long>(kPrime32));
+
+    for (size_t s = 0; s < stripes; ++s) {
+        __m256i words = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + s * kStripeSize));
+        __m256i keyed = _mm256_xor_si256(words, key);
+        __m256i keyedHi = _mm256_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1));
+        __m256i product = _mm256_mul_epu32(keyed, keyedHi);
+        __m256i swapped = _mm256_shuffle_epi32(words, _MM_SHUFFLE(1, 0, 3, 2));
+        accumulator = _mm256_add_epi64(_mm256_add_epi64(accumulator, product), swapped);
+
+        if ((s + 1) % kStripesPerScramble == 0) {
+            accumulator = _mm256_xor_si256(accumulator, _mm256_srli_epi64(accumulator, 47));
+            accumulator = _mm256_xor_si256(accumulator, scrambleKey);
+            __m256i lo = _mm256_mul_epu32(accumulator, prime);
+            __m256i hi = _mm256_mul_epu32(_mm256_srli_epi64(accumulator, 32), prime);
+            accumulator = _mm256_add_epi64(lo, _mm256_slli_epi64(hi, 32));
+        }
+    }
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc), accumulator);
+}
+
+#endif // LOG_HASH_X86
+
+AccumulateFn accumulatorFor(HashImpl impl) {
+#ifdef LOG_HASH_X86
+    if (impl == HashImpl::Avx2 && hashImplSupported(HashImpl::Avx2)) {
+        return accumulateAvx2;
+    }
+    if (impl == HashImpl::Sse2 && hashImplSupported(HashImpl::Sse2)) {
+        return accumulateSse2;
+    }
+#endif
+    (void)impl;
+    return accumulateScalar;
+}
+
+uint64_t hashWith(AccumulateFn accumulate, const void* data, size_t length, uint64_t seed) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    uint64_t h = seed ^ (length * kPrime1);
+
+    // Bulk: only worth setting up lanes once there is a full stripe
+    const size_t stripes = length / kStripeSize;
+    if (stripes > 0) {
+        uint64_t acc[4] = {seed ^ kPrime1, seed ^ kPrime2, seed ^ kPrime3, seed ^ kPrime4};
+        accumulate(acc, bytes, stripes);
+        h += mix(acc[0] ^ kMergeKey[0], acc[1] ^ kMergeKey[1]);
+        h += mix(acc[2] ^ kMergeKey[2], acc[3] ^ kMergeKey[3]);
+        bytes += stripes * kStripeSize;
+    }
+
+    // Tail: 16 bytes per folded multiply; the last pair is zero-padded and
+    // tagged with its length so trailing zero bytes still change the hash
+    size_t remaining = length % kStripeSize;
+    size_t lane = 0;
+    while (remaining >= 16) {
+        h += mix(read64(bytes) ^ kStripeKey[lane], read64(bytes + 8) ^ kStripeKey[lane + 1]);
+        lane += 2;
+        bytes += 16;
+        remaining -= 16;
+    }
+    if (remaining > 0) {
+        uint64_t words[2] = {0, 0};
+        std::memcpy(words, bytes, remaining);
+        words[1] ^= static_cast<uint64_t>(remaining) << 56;
+        h += mix(words[0] ^ kStripeKey[lane], words[1] ^ kStripeKey[lane + 1]);
+    }
+
+    return avalanche(h);
+}
+
+} // namespace
+
+bool hashImplSupported(HashImpl impl) {
+    switch (impl) {
+    case HashImpl::Scalar:
+        return true;
+#ifdef LOG_HASH_X86
+    case HashImpl::Sse2:
+        return __builtin_cpu_supports("sse2");
+    case HashImpl::Avx2:
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+HashImpl activeHashImpl() {
+    static const HashImpl impl = hashImplSupported(HashImpl::Avx2) ? HashImpl::Avx2
+                               : hashImplSupported(HashImpl::Sse2) ? HashImpl::Sse2
+                               : HashImpl::Scalar;
+    return impl;
+}
+
+const char* hashImplName(HashImpl impl) {
+    switch (impl) {
+    case HashImpl::Scalar: return "scalar";
+    case HashImpl::Sse2: return "sse2";
+    case HashImpl::Avx2: return "avx2";
+    }
+    return "unknown";
+}
+
+uint64_t hash64(const void* data, size_t length, uint64_t seed) {
+    static const AccumulateFn accumulate = accumulatorFor(activeHashImpl());
+    return hashWith(accumulate, data, length, seed);
+}
+
+uint64_t hash64With(HashImpl impl, const void* data, size_t length, uint64_t seed) {
+    return hashWith(accumulatorFor(impl), data, length, seed);
+}
+
+} // namespace DisplayDriver
@@ -0,0 +1,36 @@
+#ifndef LOG_HASH_H
+#define LOG_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace DisplayDriver {
+
+// 64-bit message hash used for deduplication keys. Input is consumed in
+// 32-byte stripes of four 64-bit lanes, so the bulk loop maps directly onto
+// SSE2/AVX2; every implementation produces identical output.
+enum class HashImpl {
+    Scalar,
+    Sse2,
+    Avx2
+};
+
+// Hash with the fastest implementation supported by this CPU
+uint64_t hash64(const void* data, size_t length, uint64_t seed = 0);
+
+inline uint64_t hash64(std::string_view text, uint64_t seed = 0) {
+    return hash64(text.data(), text.size(), seed);
+}
+
+// Explicit implementation choice (benchmarks and consistency tests).
+// Falls back to Scalar when `impl` is not supported by this CPU or build.
+uint64_t hash64With(HashImpl impl, const void* data, size_t length, uint64_t seed = 0);
+
+HashImpl activeHashImpl();
+bool hashImplSupported(HashImpl impl);
+const char* hashImplName(HashImpl impl);
+
+} // namespace DisplayDriver
+
+#endif // LOG_HASH_H
@@ -0,0 +1,182 @@
+#include "log_pipeline.h"
+#include <algorithm>
+
+namespace DisplayDriver {
+
+struct LogPipeline::Runner {
+    std::unique_ptr<EntrySink> sink;
+    SinkOptions options;
+    SinkStats stats;
+    std::vector<const LogEntry*> selected;  // Reused between batches
+
+    // Dedicated thread only
+    std::mutex mutex;
+    std::condition_variable workCv;
+    std::condition_variable idleCv;
+    std::deque<std::shared_ptr<const LogBatch>> queue;
+    bool busy = false;
+    bool stop = false;
+    std::thread thread;
+};
+
+StreamSink::StreamSink(std::ostream& stream, LogFormatter formatter)
+    : m_stream(stream), m_formatter(std::move(formatter)) {}
+
+void StreamSink::write(const LogBatch& batch, const LogEntry* const* entries, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (m_formatter) {
+            m_formatter(m_text, *entries[i], batch.wallTime(*entries[i]));
+        } else {
+            m_lineFormatter.appendLine(m_text, *entries[i], batch.wallTime(*entries[i]));
+        }
+    }
+    m_stream.write(m_text.data(), static_cast<std::streamsize>(m_text.size()));
+    m_text.clear();
+}
+
+void StreamSink::flush() {
+    m_stream.flush();
+}
+
+LogPipeline::LogPipeline() = default;
+
+LogPipeline::~LogPipeline() {
+    stop();
+}
+
+size_t LogPipeline::add(std::unique_ptr<EntrySink> sink, const SinkOptions& options) {
+    auto runner = std::make_unique<Runner>();
+    runner->sink = std::move(sink);
+    runner->options = options;
+    runner->options.maxQueuedBatches = std::max<size_t>(options.maxQueuedBatches, 1);
+    if (options.dedicatedThread) {
+        runner->thread = std::thread(&LogPipeline::threadLoop, std::ref(*runner));
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_runners.empty() || options.minimumLevel < m_minimumLevel.load(std::memory_order_relaxed)) {
+        m_minimumLevel.store(options.minimumLevel, std::memory_order_relaxed);
+    }
+    m_runners.push_back(std::move(runner));
+    return m_runners.size() - 1;
+}
+
+size_t LogPipeline::size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_runners.size();
+}
+
+const LogPipeline::SinkStats& LogPipeline::stats(size_t sink) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_runners.at(sink)->stats;
+}
+
+void LogPipeline::publish(const std::shared_ptr<const LogBatch>& batch) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& runner : m_runners) {
+        if (!runner->options.dedicatedThread) {
+            deliver(*runner, *batch);
+            runner->sink->flush();
+            continue;
+        }
+
+        // Only a reference is queued; the entries are shared with every sink
+        std::unique_lock<std::mutex> runnerLock(runner->mutex);
+        if (runner->stop) {
+            continue;
+        }
+        if (runner->queue.size() >= runner->options.maxQueuedBatches) {
+            runner->stats.droppedBatches.fetch_add(1, std::memory_order_relaxed);
+            runner->stats.droppedEntries.fetch_add(batch->entries.size(), std::memory_order_relaxed);
+            continue;
+        }
+        runner->queue.push_back(batch);
+        runnerLock.unlock();
+        runner->workCv.notify_one();
+    }
+}
+
+void LogPipeline::deliver(Runner& runner, const LogBatch& batch) {
+    runner.selected.clear();
+    for (const auto& entry : batch.entries) {
+        if (entry.level >= runner.options.minimumLevel) {
+            runner.selected.push_back(&entry);
+        }
+    }
+    if (runner.selected.empty()) {
+        return;
+    }
+
+    runner.sink->write(batch, runner.selected.data(), runner.selected.size());
+    runner.stats.batches.fetch_add(1, std::memory_order_relaxed);
+    runner.stats.entries.fetch_add(runner.selected.size(), std::memory_order_relaxed);
+}
+
+void LogPipeline::threadLoop(Runner& runner) {
+    std::unique_lock<std::mutex> lock(runner.mutex);
+    for (;;) {
+        runner.workCv.wait(lock, [&runner] { return runner.stop || !runner.queue.empty(); });
+        if (runner.queue.empty()) {
+            return;  // Stopped with everything delivered
+        }
+
+        std::shared_ptr<const LogBatch> batch = std::move(runner.queue.front());
+        runner.queue.pop_front();
+        runner.busy = true;
+        lock.unlock();
+
+        deliver(runner, *batch);
+        batch.reset();  // The last sink to finish frees the entries
+
+        lock.lock();
+        if (runner.queue.empty()) {
+            lock.unlock();
+            runner.sink->flush();
+            lock.lock();
+        }
+        runner.busy = false;
+        if (runner.queue.empty()) {
+            runner.idleCv.notify_all();
+        }
+    }
+}
+
+bool LogPipeline::waitIdle(std::chrono::milliseconds timeout) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    // Wait without m_mutex, so the flush path keeps publishing meanwhile
+    std::vector<Runner*> threaded;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& runner : m_runners) {
+            if (runner->options.dedicatedThread) {
+                threaded.push_back(runner.get());
+            }
+        }
+    }
+    for (Runner* runner : threaded) {
+        std::unique_lock<std::mutex> runnerLock(runner->mutex);
+        if (!runner->idleCv.wait_until(runnerLock, deadline,
+                                       [&runner] { return runner->queue.empty() && !runner->busy; })) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void LogPipeline::stop() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& runner : m_runners) {
+        if (!runner->thread.joinable()) {
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> runnerLock(runner->mutex);
+            runner->stop = true;
+        }
+        runner->workCv.notify_one();
+        runner->thread.join();
+    }
+}
+
+} // namespace DisplayDriver
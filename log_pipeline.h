@@ -0,0 +1,142 @@
+#ifndef LOG_PIPELINE_H
+#define LOG_PIPELINE_H
+
+#include "buffered_logger.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace DisplayDriver {
+
+// One flush worth of entries, in time order, with their text resolved.
+// Built once per flush and shared read-only by every sink that wants it, so
+// a sink thread can hold it for as long as it needs.
+struct LogBatch {
+    std::vector<LogEntry> entries;
+    ClockSource source = ClockSource::SteadyClock;
+    double ticksPerNs = 1.0;
+    ClockCalibration::Anchor anchor{};  // Calibration at the flush that built the batch
+
+    std::chrono::system_clock::time_point wallTime(const LogEntry& entry) const {
+        return ClockCalibration::toWallClock(source, ticksPerNs, anchor, entry.ticks);
+    }
+};
+
+// Consumer of flushed entries, registered with LogPipeline::add. Calls are
+// never concurrent: either the flush thread or the sink's own thread makes
+// them, so sinks need no locking of their own.
+class EntrySink {
+public:
+    virtual ~EntrySink() = default;
+
+    virtual const char* name() const = 0;
+
+    // The entries of `batch` at or above the sink's level, in order
+    virtual void write(const LogBatch& batch, const LogEntry* const* entries, size_t count) = 0;
+
+    // Nothing more is queued for now
+    virtual void flush() {}
+};
+
+// Renders one entry as text, including its trailing '\n'
+using LogFormatter = std::function<void(std::string& out, const LogEntry& entry,
+                                        std::chrono::system_clock::time_point wallTime)>;
+
+// Text lines to a stream (std::cout for Config::consoleOutput). Without a
+// formatter, lines use the standard format.
+class StreamSink : public EntrySink {
+public:
+    explicit StreamSink(std::ostream& stream, LogFormatter formatter = nullptr);
+
+    const char* name() const override { return "stream"; }
+    void write(const LogBatch& batch, const LogEntry* const* entries, size_t count) override;
+    void flush() override;
+
+private:
+    std::ostream& m_stream;
+    LogFormatter m_formatter;
+    LogLineFormatter m_lineFormatter;
+    std::string m_text;  // Reused between batches
+};
+
+// Hands the entries to a function, e.g. for forwarding to a remote collector
+class CallbackSink : public EntrySink {
+public:
+    using Callback = std::function<void(const LogBatch& batch, const LogEntry* const* entries, size_t count)>;
+
+    explicit CallbackSink(Callback callback) : m_callback(std::move(callback)) {}
+
+    const char* name() const override { return "callback"; }
+    void write(const LogBatch& batch, const LogEntry* const* entries, size_t count) override {
+        m_callback(batch, entries, count);
+    }
+
+private:
+    Callback m_callback;
+};
+
+struct SinkOptions {
+    LogLevel minimumLevel = LogLevel::TRACE;  // Entries below this are not passed to the sink
+    bool dedicatedThread = false;             // Else the flush thread calls the sink inline
+    size_t maxQueuedBatches = 64;             // Dedicated thread: further batches are dropped for this sink
+};
+
+// Fans each flushed batch out to the registered sinks. Inline sinks run on
+// the flush thread, in registration order. A sink with a dedicated thread
+// gets a bounded queue of batch references instead: when it stalls and the
+// queue fills, it loses batches while the flush and every other sink carry
+// on.
+class LogPipeline {
+public:
+    struct SinkStats {
+        std::atomic<size_t> batches{0};         // Delivered to the sink
+        std::atomic<size_t> entries{0};
+        std::atomic<size_t> droppedBatches{0};  // Queue full (dedicated thread only)
+        std::atomic<size_t> droppedEntries{0};
+    };
+
+    LogPipeline();
+    ~LogPipeline();  // Delivers what is queued, then stops the sink threads
+
+    LogPipeline(const LogPipeline&) = delete;
+    LogPipeline& operator=(const LogPipeline&) = delete;
+
+    // Returns the sink's index for stats()
+    size_t add(std::unique_ptr<EntrySink> sink, const SinkOptions& options = SinkOptions());
+    size_t size() const;
+    const SinkStats& stats(size_t sink) const;
+
+    // Lowest level any sink accepts; entries below it need not be batched
+    LogLevel minimumLevel() const { return m_minimumLevel.load(std::memory_order_relaxed); }
+    bool empty() const { return size() == 0; }
+
+    // Flush path
+    void publish(const std::shared_ptr<const LogBatch>& batch);
+
+    // Block until every sink thread has delivered its queue; false on timeout
+    bool waitIdle(std::chrono::milliseconds timeout);
+
+    // Deliver what is queued and join the sink threads; later batches go
+    // to inline sinks only
+    void stop();
+
+private:
+    struct Runner;
+
+    static void deliver(Runner& runner, const LogBatch& batch);
+    static void threadLoop(Runner& runner);
+
+    mutable std::mutex m_mutex;  // Guards the runner list, not the sinks
+    std::vector<std::unique_ptr<Runner>> m_runners;
+    std::atomic<LogLevel> m_minimumLevel{LogLevel::CRITICAL};
+};
+
+} // namespace DisplayDriver
+
+#endif // LOG_PIPELINE_H
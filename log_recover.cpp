@@ -0,0 +1,30 @@
+// Prints the entries held in a flight recorder file (Config::flightRecorderFile),
+// typically after the process that wrote it crashed.
+//
+//   log_recover driver.flight            every entry still in the ring
+//   log_recover -n 200 driver.flight     only the last 200
+//   log_recover driver.flight.prev       the recording before the last restart
+#include "log_flight_recorder.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char** argv) {
+    size_t maxEntries = SIZE_MAX;
+    int arg = 1;
+    if (arg + 1 < argc && std::strcmp(argv[arg], "-n") == 0) {
+        maxEntries = std::strtoull(argv[arg + 1], nullptr, 10);
+        arg += 2;
+    }
+    if (arg + 1 != argc) {
+        std::fprintf(stderr, "usage: %s [-n entries] file\n", argv[0]);
+        return 2;
+    }
+
+    if (!DisplayDriver::dumpFlightRecorder(argv[arg], maxEntries, stdout)) {
+        std::fprintf(stderr, "%s: %s: not a readable flight recorder\n", argv[0], argv[arg]);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,221 @@
+#include "log_rotation.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Optional zlib (set by the Makefile when it is installed); without it
+// rotated files are kept uncompressed
+#if DRIVER_LOG_ZLIB
+#include <zlib.h>
+#endif
+
+namespace DisplayDriver {
+
+namespace {
+
+constexpr const char* kCompressedSuffix = ".gz";
+constexpr const char* kPartialSuffix = ".tmp";
+
+bool fileExists(const std::string& path) {
+    struct stat st;
+    return ::stat(path.c_str(), &st) == 0;
+}
+
+// "<prefix>YYYYmmdd-HHMMSS.NNN" with an optional ".gz"; other files that
+// happen to share the prefix are left alone
+bool isRotatedName(const std::string& name, const std::string& prefix) {
+    static const char pattern[] = "dddddddd-dddddd.ddd";
+    const size_t length = sizeof(pattern) - 1;
+    if (name.size() < prefix.size() + length || name.compare(0, prefix.size(), prefix) != 0) {
+        return false;
+    }
+    for (size_t i = 0; i < length; i++) {
+        char c = name[prefix.size() + i];
+        if (pattern[i] == 'd' ? (c < '0' || c > '9') : c != pattern[i]) {
+            return false;
+        }
+    }
+    std::string rest = name.substr(prefix.size() + length);
+    return rest.empty() || rest == kCompressedSuffix;
+}
+
+} // namespace
+
+LogRotator::LogRotator(std::string path, const RotationPolicy& policy)
+    : m_path(std::move(path)), m_policy(policy) {
+    m_worker = std::thread(&LogRotator::workerLoop, this);
+}
+
+LogRotator::~LogRotator() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_workCv.notify_all();
+    m_worker.join();
+}
+
+bool LogRotator::shouldRotate(uint64_t fileBytes, std::chrono::steady_clock::time_point openedAt) const {
+    if (m_policy.maxBytes > 0 && fileBytes >= m_policy.maxBytes) {
+        return true;
+    }
+    return m_policy.maxAge.count() > 0 && fileBytes > 0 &&
+           std::chrono::steady_clock::now() - openedAt >= m_policy.maxAge;
+}
+
+bool LogRotator::rotate() {
+    // Name sorts chronologically; the counter separates rotations within a second
+    std::time_t now = std::time(nullptr);
+    std::tm local{};
+    localtime_r(&now, &local);
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &local);
+
+    // Never step back within a second: pruning may already have removed a
+    // lower sequence number, and reusing it would break the sort order
+    if (m_lastStamp != stamp) {
+        m_lastStamp = stamp;
+        m_nextSequence = 0;
+    }
+    std::string target;
+    for (; m_nextSequence < 1000; m_nextSequence++) {
+        char suffix[48];
+        std::snprintf(suffix, sizeof(suffix), ".%s.%03u", stamp, m_nextSequence);
+        target = m_path + suffix;
+        if (!fileExists(target) && !fileExists(target + kCompressedSuffix)) {
+            break;
+        }
+    }
+    if (m_nextSequence >= 1000) {
+        // Every name for this second is taken; renaming would clobber one
+        std::cerr << "Log rotation skipped: no free name for " << stamp << std::endl;
+        return false;
+    }
+    m_nextSequence++;
+
+    if (std::rename(m_path.c_str(), target.c_str()) != 0) {
+        std::cerr << "Log rotation failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back(std::move(target));
+    }
+    m_workCv.notify_one();
+    return true;
+}
+
+void LogRotator::waitIdle() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idleCv.wait(lock, [this] { return m_jobs.empty() && !m_busy; });
+}
+
+void LogRotator::workerLoop() {
+    // Compression must never compete with the flush thread or the driver
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 19);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_workCv.wait(lock, [this] { return m_stop || !m_jobs.empty(); });
+        if (m_jobs.empty()) {
+            break;  // Stopping with nothing left to do
+        }
+
+        std::string file = std::move(m_jobs.front());
+        m_jobs.pop_front();
+        m_busy = true;
+        lock.unlock();
+
+        if (m_policy.compress) {
+            compressFile(file);
+        }
+        pruneRotated();
+
+        lock.lock();
+        m_busy = false;
+        if (m_jobs.empty()) {
+            m_idleCv.notify_all();
+        }
+    }
+}
+
+void LogRotator::compressFile(const std::string& file) {
+#if DRIVER_LOG_ZLIB
+    // Write under a temporary name so a crash never leaves a truncated .gz
+    // that looks complete; the plain file is only removed once it exists
+    const std::string compressed = file + kCompressedSuffix;
+    const std::string partial = compressed + kPartialSuffix;
+
+    std::FILE* input = std::fopen(file.c_str(), "rb");
+    gzFile output = input ? gzopen(partial.c_str(), "wb6") : nullptr;
+    bool ok = input && output;
+
+    std::vector<char> buffer(256 * 1024);
+    while (ok) {
+        size_t read = std::fread(buffer.data(), 1, buffer.size(), input);
+        if (read == 0) {
+            ok = !std::ferror(input);
+            break;
+        }
+        ok = gzwrite(output, buffer.data(), static_cast<unsigned>(read)) == static_cast<int>(read);
+    }
+
+    if (input) {
+        std::fclose(input);
+    }
+    if (output && gzclose(output) != Z_OK) {
+        ok = false;
+    }
+
+    if (ok && std::rename(partial.c_str(), compressed.c_str()) == 0) {
+        std::remove(file.c_str());
+    } else {
+        std::remove(partial.c_str());  // Keep the uncompressed file instead
+    }
+#else
+    (void)file;
+#endif
+}
+
+void LogRotator::pruneRotated() {
+    namespace fs = std::filesystem;
+
+    const fs::path active(m_path);
+    const fs::path directory = active.has_parent_path() ? active.parent_path() : fs::path(".");
+    const std::string prefix = active.filename().string() + ".";
+
+    // Non-throwing iteration: this runs on the worker thread, where an
+    // escaping filesystem_error would terminate the process
+    std::vector<std::string> rotated;
+    std::error_code error;
+    for (fs::directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+        std::string name = it->path().filename().string();
+        if (isRotatedName(name, prefix)) {
+            rotated.push_back(it->path().string());
+        }
+    }
+    if (error) {
+        return;  // Retried after the next rotation
+    }
+    if (rotated.size() <= m_policy.maxFiles) {
+        return;
+    }
+
+    // Timestamped names sort oldest first, with or without ".gz"
+    std::sort(rotated.begin(), rotated.end());
+    for (size_t i = 0; i + m_policy.maxFiles < rotated.size(); i++) {
+        std::remove(rotated[i].c_str());
+    }
+}
+
+} // namespace DisplayDriver
@@ -0,0 +1,65 @@
+#ifndef LOG_ROTATION_H
+#define LOG_ROTATION_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace DisplayDriver {
+
+struct RotationPolicy {
+    uint64_t maxBytes = 0;                   // Rotate once the active file reaches this size (0 = never)
+    std::chrono::seconds maxAge{0};          // Rotate files older than this (0 = never)
+    size_t maxFiles = 5;                     // Rotated files kept; older ones are deleted
+    bool compress = true;                    // gzip rotated files in the background (zlib builds only)
+};
+
+// Moves the active log aside as "<path>.<YYYYmmdd-HHMMSS>.<NNN>" and leaves
+// compression and pruning to a low-priority background thread. Rotated names
+// are unique and never reused, so the worker can compress a file while later
+// rotations carry on. rotate() itself is one rename and belongs to the
+// flush path; the caller closes the active file first and reopens it after.
+class LogRotator {
+public:
+    LogRotator(std::string path, const RotationPolicy& policy);
+    ~LogRotator();  // Finishes queued compression
+
+    LogRotator(const LogRotator&) = delete;
+    LogRotator& operator=(const LogRotator&) = delete;
+
+    bool shouldRotate(uint64_t fileBytes, std::chrono::steady_clock::time_point openedAt) const;
+
+    // Rename the closed active file aside; false if the rename failed
+    bool rotate();
+
+    // Block until queued compression and pruning are done
+    void waitIdle();
+
+    const std::string& path() const { return m_path; }
+
+private:
+    void workerLoop();
+    void compressFile(const std::string& file);
+    void pruneRotated();
+
+    std::string m_path;
+    RotationPolicy m_policy;
+    std::string m_lastStamp;         // Flush thread only
+    unsigned m_nextSequence = 0;
+
+    std::mutex m_mutex;
+    std::condition_variable m_workCv;
+    std::condition_variable m_idleCv;
+    std::deque<std::string> m_jobs;  // Rotated files awaiting compression and pruning
+    bool m_busy = false;
+    bool m_stop = false;
+    std::thread m_worker;
+};
+
+} // namespace DisplayDriver
+
+#endif // LOG_ROTATION_H
@@ -0,0 +1,869 @@
+#include "log_sink.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <climits>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define LOG_SINK_IO_URING 1
+#endif
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+namespace DisplayDriver {
+
+namespace {
+
+constexpr size_t kPageSize = 4096;
+
+size_t roundUpToPage(size_t size) {
+    return (size + kPageSize - 1) & ~(kPageSize - 1);
+}
+
+} // namespace
+
+FileSink::FileSink(const std::string& path) {
+    m_fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (m_fd < 0) {
+        std::cerr << "Failed to open log file: " << path << std::endl;
+    }
+}
+
+FileSink::~FileSink() {
+    close();
+}
+
+void FileSink::write(const std::string_view* blocks, size_t count) {
+    if (m_fd < 0) {
+        return;
+    }
+
+    std::vector<iovec>& iov = m_iov;
+    size_t next = 0;
+    while (next < count) {
+        iov.clear();
+        while (next < count && iov.size() < IOV_MAX) {
+            if (!blocks[next].empty()) {
+                iov.push_back({const_cast<char*>(blocks[next].data()), blocks[next].size()});
+            }
+            next++;
+        }
+
+        // Short writes (signals, full disks) resume where the kernel stopped
+        size_t first = 0;
+        while (first < iov.size()) {
+            ssize_t written = ::writev(m_fd, iov.data() + first, static_cast<int>(iov.size() - first));
+            m_syscalls++;
+            if (written <= 0) {
+                if (written < 0 && errno == EINTR) {
+                    continue;
+                }
+                // No progress with bytes left would otherwise retry forever
+                if (!m_reportedError) {
+                    std::cerr << "Log write failed: "
+                              << (written < 0 ? std::strerror(errno) : "no bytes written") << std::endl;
+                    m_reportedError = true;
+                }
+                return;
+            }
+
+            m_bytesWritten += static_cast<size_t>(written);
+            m_bytesAppended += static_cast<size_t>(written);
+            size_t remaining = static_cast<size_t>(written);
+            while (first < iov.size() && remaining >= iov[first].iov_len) {
+                remaining -= iov[first].iov_len;
+                first++;
+            }
+            if (first < iov.size()) {
+                iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + remaining;
+                iov[first].iov_len -= remaining;
+            }
+        }
+    }
+}
+
+void FileSink::close() {
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+#ifdef LOG_SINK_IO_URING
+
+namespace {
+
+// io_uring through the raw syscalls (no liburing). Blocks are copied into a
+// small set of page-aligned buffers registered with the kernel; each full
+// buffer becomes one WRITE_FIXED at an explicit offset, so several can be in
+// flight while the flush thread renders the next batch. Offsets are assigned
+// here rather than by O_APPEND, which would not keep concurrent writes in
+// order; the sink therefore assumes it is the file's only writer. If the
+// ring itself stops working, what it has not confirmed is rewritten with
+// pwrite and the sink stays synchronous from then on.
+class IoUringFileSink : public LogSink {
+    static constexpr int kMaxInterrupts = 16;  // io_uring_enter retries on EINTR
+
+public:
+    IoUringFileSink(const std::string& path, const FileSinkOptions& options)
+        : m_bufferSize(roundUpToPage(std::max<size_t>(options.blockSize, 256 * 1024))) {
+        if (!setupRing(static_cast<unsigned>(std::max<size_t>(options.queueDepth, 2)))) {
+            return;
+        }
+
+        m_fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+        struct stat st;
+        if (m_fd < 0 || fstat(m_fd, &st) != 0) {
+            std::cerr << "Failed to open log file: " << path << std::endl;
+            teardown();
+            return;
+        }
+        m_offset = static_cast<uint64_t>(st.st_size);
+
+        m_buffers.resize(m_sqEntries);
+        std::vector<iovec> iov(m_buffers.size());
+        for (size_t i = 0; i < m_buffers.size(); i++) {
+            m_buffers[i].data = static_cast<char*>(std::aligned_alloc(kPageSize, m_bufferSize));
+            if (!m_buffers[i].data) {
+                teardown();
+                return;
+            }
+            iov[i] = {m_buffers[i].data, m_bufferSize};
+            m_free.push_back(static_cast<unsigned>(i));
+        }
+
+        // Registration pins the pages once instead of per write; without it
+        // (e.g. RLIMIT_MEMLOCK) plain WRITE still works from the same buffers
+        m_fixedBuffers = syscall(__NR_io_uring_register, m_ringFd, IORING_REGISTER_BUFFERS,
+                                 iov.data(), static_cast<unsigned>(iov.size())) == 0;
+    }
+
+    ~IoUringFileSink() override {
+        close();
+    }
+
+    bool isOpen() const override { return m_fd >= 0; }
+    const char* name() const override { return "io_uring"; }
+
+    void write(const std::string_view* blocks, size_t count) override {
+        if (m_fd < 0) {
+            return;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            const char* data = blocks[i].data();
+            size_t remaining = blocks[i].size();
+            while (remaining > 0) {
+                if (m_failed) {
+                    writeAt(data, remaining, m_offset);
+                    m_offset += remaining;
+                    break;
+                }
+                Buffer& buffer = fillingBuffer();
+                if (m_failed) {
+                    continue;  // The ring broke while waiting for a buffer
+                }
+                size_t chunk = std::min(remaining, m_bufferSize - buffer.size);
+                std::memcpy(buffer.data + buffer.size, data, chunk);
+                buffer.size += chunk;
+                data += chunk;
+                remaining -= chunk;
+
+                if (buffer.size == m_bufferSize) {
+                    queueFilling();
+                }
+            }
+        }
+        submit(0);
+    }
+
+    void flush() override {
+        if (m_fd < 0 || m_failed) {
+            return;
+        }
+
+        // Hand the partial buffer over too, but don't wait for the disk
+        if (m_filling >= 0 && m_buffers[m_filling].size > 0) {
+            queueFilling();
+        }
+        submit(0);
+        reapCompletions();
+    }
+
+    void close() override {
+        if (m_fd >= 0) {
+            flush();
+            while (m_inFlight > 0) {
+                submit(1);
+                reapCompletions();
+            }
+            ::close(m_fd);
+            m_fd = -1;
+        }
+        teardown();
+    }
+
+    bool ready() const { return m_ringFd >= 0 && m_fd >= 0; }
+
+private:
+    struct Buffer {
+        char* data = nullptr;
+        size_t size = 0;     // Bytes filled
+        size_t written = 0;  // Bytes the kernel has completed (short writes resume here)
+        uint64_t offset = 0; // File offset of data[0]
+        bool queued = false; // Handed to the kernel and not yet completed
+    };
+
+    bool setupRing(unsigned entries) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        m_ringFd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (m_ringFd < 0) {
+            return false;
+        }
+        m_sqEntries = params.sq_entries;
+
+        m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMap) {
+            m_sqRingSize = m_cqRingSize = std::max(m_sqRingSize, m_cqRingSize);
+        }
+
+        m_sqRing = mmap(nullptr, m_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        m_ringFd, IORING_OFF_SQ_RING);
+        if (m_sqRing == MAP_FAILED) {
+            m_sqRing = nullptr;
+            teardown();
+            return false;
+        }
+        m_cqRing = singleMap ? m_sqRing
+                             : mmap(nullptr, m_cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                    m_ringFd, IORING_OFF_CQ_RING);
+        m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = m_cqRing == MAP_FAILED ? MAP_FAILED
+                   : mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          m_ringFd, IORING_OFF_SQES);
+        if (m_cqRing == MAP_FAILED || sqes == MAP_FAILED) {
+            if (m_cqRing == MAP_FAILED) {
+                m_cqRing = nullptr;
+            }
+            teardown();
+            return false;
+        }
+        m_sqes = static_cast<io_uring_sqe*>(sqes);
+
+        char* sq = static_cast<char*>(m_sqRing);
+        m_sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        m_sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        m_sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        char* cq = static_cast<char*>(m_cqRing);
+        m_cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        m_cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        m_cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        m_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    void teardown() {
+        if (m_ringFd >= 0) {
+            if (m_fixedBuffers) {
+                syscall(__NR_io_uring_register, m_ringFd, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+                m_fixedBuffers = false;
+            }
+            if (m_sqes) {
+                munmap(m_sqes, m_sqesSize);
+            }
+            if (m_cqRing && m_cqRing != m_sqRing) {
+                munmap(m_cqRing, m_cqRingSize);
+            }
+            if (m_sqRing) {
+                munmap(m_sqRing, m_sqRingSize);
+            }
+            ::close(m_ringFd);
+            m_ringFd = -1;
+        }
+        m_sqes = nullptr;
+        m_sqRing = m_cqRing = nullptr;
+
+        for (Buffer& buffer : m_buffers) {
+            std::free(buffer.data);
+        }
+        m_buffers.clear();
+        m_free.clear();
+        m_filling = -1;
+        if (m_fd >= 0) {
+            ::close(m_fd);
+            m_fd = -1;
+        }
+    }
+
+    Buffer& fillingBuffer() {
+        if (m_filling < 0) {
+            // Every buffer in flight: take any finished ones, else wait
+            // (half the pool at a time, so waits are batched too)
+            reapCompletions();
+            while (m_free.empty() && !m_failed) {
+                submit(std::max(1u, m_inFlight / 2));
+                reapCompletions();
+            }
+            m_filling = static_cast<int>(m_free.back());
+            m_free.pop_back();
+            Buffer& buffer = m_buffers[m_filling];
+            buffer.size = 0;
+            buffer.written = 0;
+        }
+        return m_buffers[m_filling];
+    }
+
+    // Assign the filling buffer its file range and queue its write
+    void queueFilling() {
+        Buffer& buffer = m_buffers[m_filling];
+        buffer.offset = m_offset;
+        m_offset += buffer.size;
+        buffer.queued = true;
+        queueWrite(static_cast<unsigned>(m_filling));
+        m_filling = -1;
+        m_inFlight++;
+    }
+
+    void queueWrite(unsigned index) {
+        const Buffer& buffer = m_buffers[index];
+        const unsigned tail = *m_sqTail;  // Only this thread produces SQEs
+        const unsigned slot = tail & m_sqMask;
+
+        io_uring_sqe& sqe = m_sqes[slot];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = m_fixedBuffers ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+        sqe.fd = m_fd;
+        sqe.addr = reinterpret_cast<uint64_t>(buffer.data + buffer.written);
+        sqe.len = static_cast<uint32_t>(buffer.size - buffer.written);
+        sqe.off = buffer.offset + buffer.written;
+        sqe.buf_index = static_cast<uint16_t>(index);
+        sqe.user_data = index;
+
+        m_sqArray[slot] = slot;
+        __atomic_store_n(m_sqTail, tail + 1, __ATOMIC_RELEASE);
+        m_toSubmit++;
+    }
+
+    // One io_uring_enter covers everything queued, optionally waiting. Any
+    // error but a brief run of EINTR abandons the ring (see fail)
+    void submit(unsigned waitFor) {
+        if (m_failed || (m_toSubmit == 0 && waitFor == 0)) {
+            return;
+        }
+        for (int attempt = 0;; attempt++) {
+            long result = syscall(__NR_io_uring_enter, m_ringFd, m_toSubmit, waitFor,
+                                  waitFor > 0 ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0);
+            m_syscalls++;
+            if (result >= 0) {
+                m_toSubmit -= std::min<unsigned>(m_toSubmit, static_cast<unsigned>(result));
+                return;
+            }
+            if (errno != EINTR || attempt == kMaxInterrupts) {
+                fail(errno);
+                return;
+            }
+        }
+    }
+
+    // The ring cannot be relied on to submit or complete anything more.
+    // Every buffer it has not confirmed is written again with pwrite at its
+    // own offset (bytes the kernel did finish are rewritten unchanged), then
+    // the sink writes synchronously. Buffers stay allocated until teardown,
+    // as the kernel may still be reading the ones it was given.
+    void fail(int error) {
+        reportError(std::strerror(error));
+        m_failed = true;
+        for (Buffer& buffer : m_buffers) {
+            if (buffer.queued) {
+                writeAt(buffer.data + buffer.written, buffer.size - buffer.written, buffer.offset + buffer.written);
+                buffer.queued = false;
+            }
+        }
+        if (m_filling >= 0) {
+            Buffer& buffer = m_buffers[m_filling];
+            writeAt(buffer.data, buffer.size, m_offset);
+            m_offset += buffer.size;
+            m_filling = -1;
+        }
+        m_free.clear();
+        for (size_t i = 0; i < m_buffers.size(); i++) {
+            m_free.push_back(static_cast<unsigned>(i));
+        }
+        m_inFlight = 0;
+        m_toSubmit = 0;
+    }
+
+    void writeAt(const char* data, size_t size, uint64_t offset) {
+        while (size > 0) {
+            ssize_t written = ::pwrite(m_fd, data, size, static_cast<off_t>(offset));
+            m_syscalls++;
+            if (written <= 0) {
+                if (written < 0 && errno == EINTR) {
+                    continue;
+                }
+                reportError(written < 0 ? std::strerror(errno) : "no bytes written");
+                return;
+            }
+            m_bytesWritten += static_cast<size_t>(written);
+            m_bytesAppended += static_cast<size_t>(written);
+            data += written;
+            size -= static_cast<size_t>(written);
+            offset += static_cast<uint64_t>(written);
+        }
+    }
+
+    void reapCompletions() {
+        if (m_failed) {
+            return;
+        }
+        unsigned head = *m_cqHead;
+        const unsigned tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+        while (head != tail) {
+            const io_uring_cqe& cqe = m_cqes[head & m_cqMask];
+            const unsigned index = static_cast<unsigned>(cqe.user_data);
+            const int result = cqe.res;
+            head++;
+
+            Buffer& buffer = m_buffers[index];
+            if (result <= 0) {
+                // No progress on a short write is a failure too, not a finished buffer
+                reportError(result < 0 ? std::strerror(-result) : "no bytes written");
+                buffer.written = buffer.size;  // Drop it; retrying a failing disk only stalls the flush path
+            } else {
+                buffer.written += static_cast<size_t>(result);
+                m_bytesWritten += static_cast<size_t>(result);
+                m_bytesAppended += static_cast<size_t>(result);
+            }
+
+            if (buffer.written < buffer.size) {
+                queueWrite(index);  // Short write: resume the remainder
+            } else {
+                buffer.queued = false;
+                m_free.push_back(index);
+                m_inFlight--;
+            }
+        }
+        __atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);
+    }
+
+    void reportError(const char* message) {
+        if (!m_reportedError) {
+            std::cerr << "Log write failed: " << message << std::endl;
+            m_reportedError = true;
+        }
+    }
+
+    int m_ringFd = -1;
+    int m_fd = -1;
+    unsigned m_sqEntries = 0;
+    size_t m_bufferSize;
+    bool m_fixedBuffers = false;
+    bool m_reportedError = false;
+    bool m_failed = false;   // Ring abandoned: writes go through pwrite
+
+    void* m_sqRing = nullptr;
+    void* m_cqRing = nullptr;
+    size_t m_sqRingSize = 0;
+    size_t m_cqRingSize = 0;
+    io_uring_sqe* m_sqes = nullptr;
+    size_t m_sqesSize = 0;
+    unsigned* m_sqTail = nullptr;
+    unsigned m_sqMask = 0;
+    unsigned* m_sqArray = nullptr;
+    unsigned* m_cqHead = nullptr;
+    unsigned* m_cqTail = nullptr;
+    unsigned m_cqMask = 0;
+    io_uring_cqe* m_cqes = nullptr;
+
+    std::vector<Buffer> m_buffers;
+    std::vector<unsigned> m_free;
+    int m_filling = -1;      // Buffer currently being copied into
+    unsigned m_inFlight = 0;
+    unsigned m_toSubmit = 0;
+    uint64_t m_offset = 0;   // Next file offset to assign
+};
+
+} // namespace
+
+#endif // LOG_SINK_IO_URING
+
+namespace {
+
+// Page-cache bypass: bytes are staged in an aligned buffer and written as
+// whole 4 KiB blocks at aligned offsets. A flush pads the partial last block
+// with zeros and then trims the file back to its logical length, so readers
+// never see the padding; the block is rewritten in full once it fills.
+class DirectFileSink : public LogSink {
+public:
+    DirectFileSink(const std::string& path, const FileSinkOptions& options)
+        : m_capacity(roundUpToPage(std::max<size_t>(options.blockSize, 1024 * 1024))) {
+        m_fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_DIRECT | O_CLOEXEC, 0644);
+        struct stat st;
+        if (m_fd < 0 || fstat(m_fd, &st) != 0) {
+            closeFd();
+            return;
+        }
+        m_buffer = static_cast<char*>(std::aligned_alloc(kPageSize, m_capacity));
+        if (!m_buffer) {
+            closeFd();
+            return;
+        }
+
+        // Resume inside the existing last block: its bytes are rewritten
+        // together with the first new ones
+        m_logicalSize = static_cast<uint64_t>(st.st_size);
+        m_bufferOffset = m_logicalSize & ~static_cast<uint64_t>(kPageSize - 1);
+        m_size = static_cast<size_t>(m_logicalSize - m_bufferOffset);
+        if (m_size > 0) {
+            int reader = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            bool restored = reader >= 0 &&
+                            ::pread(reader, m_buffer, m_size, static_cast<off_t>(m_bufferOffset)) ==
+                                static_cast<ssize_t>(m_size);
+            if (reader >= 0) {
+                ::close(reader);
+            }
+            if (!restored) {
+                closeFd();
+            }
+        }
+    }
+
+    ~DirectFileSink() override {
+        close();
+    }
+
+    bool isOpen() const override { return m_fd >= 0; }
+    const char* name() const override { return "o_direct"; }
+
+    void write(const std::string_view* blocks, size_t count) override {
+        if (m_fd < 0) {
+            return;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            const char* data = blocks[i].data();
+            size_t remaining = blocks[i].size();
+            while (remaining > 0) {
+                size_t chunk = std::min(remaining, m_capacity - m_size);
+                std::memcpy(m_buffer + m_size, data, chunk);
+                m_size += chunk;
+                m_logicalSize += chunk;
+                m_bytesAppended += chunk;
+                m_dirty = true;
+                data += chunk;
+                remaining -= chunk;
+
+                if (m_size == m_capacity) {
+                    writeBuffer(m_capacity);
+                    m_bufferOffset += m_capacity;
+                    m_size = 0;
+                }
+            }
+        }
+    }
+
+    void flush() override {
+        if (m_fd < 0 || !m_dirty) {
+            return;
+        }
+        m_dirty = false;
+        if (m_size == 0) {
+            return;
+        }
+
+        // Whole blocks are final; the partial one is padded now and kept
+        // staged so the next flush rewrites it with more data
+        const size_t whole = m_size & ~(kPageSize - 1);
+        const size_t tail = m_size - whole;
+        if (tail > 0) {
+            std::memset(m_buffer + m_size, 0, kPageSize - tail);
+        }
+        writeBuffer(roundUpToPage(m_size));
+        if (tail > 0) {
+            trimToLogicalSize();
+        }
+
+        if (whole > 0) {
+            std::memmove(m_buffer, m_buffer + whole, tail);
+            m_bufferOffset += whole;
+            m_size = tail;
+        }
+    }
+
+    void close() override {
+        if (m_fd >= 0) {
+            flush();
+        }
+        closeFd();
+        std::free(m_buffer);
+        m_buffer = nullptr;
+    }
+
+private:
+    // The staged tail block is padded and rewritten on every flush, so the
+    // bytes issued here exceed the log bytes appended
+    void writeBuffer(size_t length) {
+        size_t done = 0;
+        while (done < length) {
+            ssize_t written = ::pwrite(m_fd, m_buffer + done, length - done,
+                                       static_cast<off_t>(m_bufferOffset + done));
+            m_syscalls++;
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                reportError(errno);
+                return;
+            }
+            m_bytesWritten += static_cast<size_t>(written);
+            done += static_cast<size_t>(written);
+            if (done < length && (written == 0 || (done & (kPageSize - 1)) != 0)) {
+                // O_DIRECT would reject the unaligned remainder (a full disk
+                // usually); give up on this block rather than retry it
+                reportError(written == 0 ? ENOSPC : EIO);
+                return;
+            }
+        }
+    }
+
+    void trimToLogicalSize() {
+        m_syscalls++;
+        if (::ftruncate(m_fd, static_cast<off_t>(m_logicalSize)) != 0) {
+            reportError(errno);
+        }
+    }
+
+    void reportError(int error) {
+        if (!m_reportedError) {
+            std::cerr << "Log write failed: " << std::strerror(error) << std::endl;
+            m_reportedError = true;
+        }
+    }
+
+    void closeFd() {
+        if (m_fd >= 0) {
+            ::close(m_fd);
+            m_fd = -1;
+        }
+    }
+
+    int m_fd = -1;
+    char* m_buffer = nullptr;
+    size_t m_capacity;
+    size_t m_size = 0;            // Staged bytes, starting at m_bufferOffset
+    uint64_t m_bufferOffset = 0;  // Block-aligned file offset of m_buffer[0]
+    uint64_t m_logicalSize = 0;   // Real file length (excludes padding)
+    bool m_dirty = false;         // Staged bytes not yet on disk
+    bool m_reportedError = false;
+};
+
+// Appends by copying into a MAP_SHARED window of the file, so a flush costs
+// no system calls at all. The file is grown with fallocate one chunk ahead
+// (reserving blocks, so a full disk fails there rather than as SIGBUS on a
+// store) and the window moves forward a chunk at a time. Until close()
+// trims it, the file ends in zeroed preallocated space.
+class MmapFileSink : public LogSink {
+public:
+    MmapFileSink(const std::string& path, const FileSinkOptions& options)
+        : m_chunkSize(roundUpToPage(std::max<size_t>(options.mapChunkSize, kPageSize))) {
+        m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        struct stat st;
+        if (m_fd < 0 || fstat(m_fd, &st) != 0) {
+            closeFd();
+            return;
+        }
+        m_allocatedSize = static_cast<uint64_t>(st.st_size);
+        m_logicalSize = dataEnd(m_allocatedSize);
+        if (!mapWindow(m_logicalSize)) {
+            // Leave no preallocated zeros for the fallback sink to append after
+            if (m_allocatedSize != m_logicalSize) {
+                m_syscalls++;
+                (void)::ftruncate(m_fd, static_cast<off_t>(m_logicalSize));
+            }
+            closeFd();
+        }
+    }
+
+    ~MmapFileSink() override {
+        close();
+    }
+
+    bool isOpen() const override { return m_fd >= 0; }
+    const char* name() const override { return "mmap"; }
+
+    void write(const std::string_view* blocks, size_t count) override {
+        if (m_fd < 0) {
+            return;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            const char* data = blocks[i].data();
+            size_t remaining = blocks[i].size();
+            while (remaining > 0) {
+                if (!m_window || m_logicalSize == m_windowOffset + m_windowSize) {
+                    if (!mapWindow(m_logicalSize)) {
+                        return;
+                    }
+                }
+
+                size_t space = static_cast<size_t>(m_windowOffset + m_windowSize - m_logicalSize);
+                size_t chunk = std::min(remaining, space);
+                std::memcpy(m_window + (m_logicalSize - m_windowOffset), data, chunk);
+                m_logicalSize += chunk;
+                m_bytesWritten += chunk;
+                m_bytesAppended += chunk;
+                data += chunk;
+                remaining -= chunk;
+            }
+        }
+    }
+
+    void close() override {
+        if (m_fd >= 0) {
+            unmapWindow();
+            m_syscalls++;
+            if (::ftruncate(m_fd, static_cast<off_t>(m_logicalSize)) != 0) {
+                reportError(errno);
+            }
+        }
+        closeFd();
+    }
+
+private:
+    // End of the data in a file of `size` bytes. close() trims to the byte,
+    // but a process that died before it leaves the preallocated tail as
+    // zeros up to a page boundary: resume after the last non-NUL byte then
+    // instead of after the zeros.
+    uint64_t dataEnd(uint64_t size) {
+        if (size % kPageSize != 0) {
+            return size;
+        }
+        char page[kPageSize];
+        for (uint64_t end = size; end > 0; end -= kPageSize) {
+            m_syscalls++;
+            if (::pread(m_fd, page, kPageSize, static_cast<off_t>(end - kPageSize)) !=
+                static_cast<ssize_t>(kPageSize)) {
+                return end;
+            }
+            for (size_t i = kPageSize; i > 0; i--) {
+                if (page[i - 1] != '\0') {
+                    return end - kPageSize + i;
+                }
+            }
+        }
+        return 0;
+    }
+
+    // Map one chunk starting at the page containing `position`, growing the
+    // file first when the chunk reaches past what has been allocated
+    bool mapWindow(uint64_t position) {
+        unmapWindow();
+
+        const uint64_t start = position & ~static_cast<uint64_t>(kPageSize - 1);
+        const uint64_t end = start + m_chunkSize;
+        if (end > m_allocatedSize) {
+            m_syscalls++;
+            int result = ::fallocate(m_fd, 0, static_cast<off_t>(m_allocatedSize),
+                                     static_cast<off_t>(end - m_allocatedSize));
+            if (result != 0 && (errno == EOPNOTSUPP || errno == ENOSYS)) {
+                // No preallocation on this filesystem: at least extend the size
+                m_syscalls++;
+                result = ::ftruncate(m_fd, static_cast<off_t>(end));
+            }
+            if (result != 0) {
+                reportError(errno);
+                return false;
+            }
+            m_allocatedSize = end;
+        }
+
+        m_syscalls++;
+        void* window = mmap(nullptr, m_chunkSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd,
+                            static_cast<off_t>(start));
+        if (window == MAP_FAILED) {
+            reportError(errno);
+            return false;
+        }
+        m_window = static_cast<char*>(window);
+        m_windowOffset = start;
+        m_windowSize = m_chunkSize;
+        return true;
+    }
+
+    void unmapWindow() {
+        if (m_window) {
+            m_syscalls++;
+            munmap(m_window, m_windowSize);
+            m_window = nullptr;
+            m_windowSize = 0;
+        }
+    }
+
+    void reportError(int error) {
+        if (!m_reportedError) {
+            std::cerr << "Log write failed: " << std::strerror(error) << std::endl;
+            m_reportedError = true;
+        }
+    }
+
+    void closeFd() {
+        unmapWindow();
+        if (m_fd >= 0) {
+            ::close(m_fd);
+            m_fd = -1;
+        }
+    }
+
+    int m_fd = -1;
+    size_t m_chunkSize;
+    char* m_window = nullptr;
+    uint64_t m_windowOffset = 0;   // File offset of m_window[0] (page-aligned)
+    size_t m_windowSize = 0;
+    uint64_t m_logicalSize = 0;    // Bytes of real log data
+    uint64_t m_allocatedSize = 0;  // File size including preallocated space
+    bool m_reportedError = false;
+};
+
+} // namespace
+
+std::unique_ptr<LogSink> createFileSink(const std::string& path, const FileSinkOptions& options) {
+#ifdef LOG_SINK_IO_URING
+    if (options.type == FileSinkType::IoUring) {
+        auto sink = std::make_unique<IoUringFileSink>(path, options);
+        if (sink->ready()) {
+            return sink;
+        }
+        // Kernel without io_uring (or it is disabled): use the blocking path
+    }
+#endif
+    if (options.type == FileSinkType::Direct) {
+        auto sink = std::make_unique<DirectFileSink>(path, options);
+        if (sink->isOpen()) {
+            return sink;
+        }
+        // Filesystem without O_DIRECT (older tmpfs, some FUSE): use the blocking path
+    }
+    if (options.type == FileSinkType::Mmap) {
+        auto sink = std::make_unique<MmapFileSink>(path, options);
+        if (sink->isOpen()) {
+            return sink;
+        }
+    }
+    return std::make_unique<FileSink>(path);
+}
+
+} // namespace DisplayDriver
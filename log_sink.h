@@ -0,0 +1,89 @@
+#ifndef LOG_SINK_H
+#define LOG_SINK_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct iovec;
+
+namespace DisplayDriver {
+
+// Destination for rendered log bytes. The flush path is the only caller, so
+// sinks need no locking of their own. Blocks are only valid for the duration
+// of write(); a sink that defers I/O copies them first.
+class LogSink {
+public:
+    virtual ~LogSink() = default;
+
+    virtual bool isOpen() const = 0;
+    virtual const char* name() const = 0;
+
+    // Append `count` blocks, in order
+    virtual void write(const std::string_view* blocks, size_t count) = 0;
+
+    // End of a flush cycle: everything written so far is handed to the
+    // kernel. Asynchronous sinks may still complete it later; close() waits.
+    virtual void flush() {}
+
+    virtual void close() = 0;
+
+    // Output system calls issued and the bytes they transferred so far,
+    // including block padding and rewrites
+    size_t syscallCount() const { return m_syscalls; }
+    size_t bytesWritten() const { return m_bytesWritten; }
+
+    // Log bytes the file has grown by, excluding padding and preallocation:
+    // the size the file had when opened plus this is its real length
+    size_t bytesAppended() const { return m_bytesAppended; }
+
+protected:
+    size_t m_syscalls = 0;
+    size_t m_bytesWritten = 0;
+    size_t m_bytesAppended = 0;
+};
+
+// Appends through a plain file descriptor: every write() call gathers its
+// blocks into a single writev (split only at IOV_MAX)
+class FileSink : public LogSink {
+public:
+    explicit FileSink(const std::string& path);
+    ~FileSink() override;
+
+    FileSink(const FileSink&) = delete;
+    FileSink& operator=(const FileSink&) = delete;
+
+    bool isOpen() const override { return m_fd >= 0; }
+    const char* name() const override { return "writev"; }
+    void write(const std::string_view* blocks, size_t count) override;
+    void close() override;
+
+private:
+    int m_fd = -1;
+    bool m_reportedError = false;
+    std::vector<iovec> m_iov;  // Reused gather list
+};
+
+enum class FileSinkType {
+    Writev,   // Blocking writev on the flush thread
+    IoUring,  // Asynchronous io_uring writes; falls back to Writev when unavailable
+    Direct,   // O_DIRECT 4 KiB-aligned writes that bypass the page cache; falls back to Writev
+    Mmap      // Copies into a shared mapping of a preallocated file; falls back to Writev
+};
+
+struct FileSinkOptions {
+    FileSinkType type = FileSinkType::Writev;
+    size_t blockSize = 64 * 1024;  // Staging buffer size for sinks that copy (Direct: at least 1 MiB)
+    size_t queueDepth = 8;         // io_uring: registered buffers / writes in flight
+    size_t mapChunkSize = 64 * 1024 * 1024;  // Mmap: preallocation and mapping window
+};
+
+// Opens the requested sink, falling back to FileSink when the kernel or
+// build does not support it
+std::unique_ptr<LogSink> createFileSink(const std::string& path, const FileSinkOptions& options);
+
+} // namespace DisplayDriver
+
+#endif // LOG_SINK_H
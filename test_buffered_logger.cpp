@@ -1,4 +1,10 @@
+// Compile TRACE macro sites out of this file (see testCompileTimeLevels)
+#define DRIVER_LOG_ACTIVE_LEVEL DRIVER_LOG_LEVEL_DEBUG
+
 #include "buffered_logger.h"
+#include "log_hash.h"
+#include "log_compress.h"
+#include "log_pipeline.h"
 #include <iostream>
 #include <cassert>
 #include <random>
@@ -9,10 +15,53 @@
 #include <sstream>
 #include <fstream>
 #include <iomanip>
+#include <cstdlib>
+#include <new>
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <csignal>
+#if DRIVER_LOG_ZLIB
+#include <zlib.h>
+#endif
+#include <filesystem>
+#include <ctime>
 
 using namespace DisplayDriver;
 using namespace std::chrono_literals;
 
+// Per-thread heap allocation counter for the allocation-free hot path test
+static thread_local bool t_countAllocations = false;
+static thread_local size_t t_allocationCount = 0;
+
+void* operator new(std::size_t size) {
+    if (t_countAllocations) {
+        t_allocationCount++;
+    }
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
 class TestHarness {
 private:
     int m_totalTests = 0;
@@ -225,6 +274,7 @@ void testMemoryLimit(TestHarness& harness) {
         config.consoleOutput = false;
         config.maxMemoryBytes = 1024;  // 1KB limit
         config.asyncFlush = false;
+        config.enableDeduplication = false;  // Identical messages would otherwise collapse into one
         
         BufferedLogger logger(config);
         
@@ -618,80 +668,2711 @@ void testShutdownCleanup(TestHarness& harness) {
     }
 }
 
-// Performance Benchmark
-void runPerformanceBenchmark() {
-    std::cout << "\n========================================" << std::endl;
-    std::cout << "Performance Benchmark" << std::endl;
-    std::cout << "========================================" << std::endl;
-    
-    struct BenchmarkConfig {
-        std::string name;
-        bool asyncFlush;
-        bool deduplication;
-        size_t bufferSize;
-        int numThreads;
-    };
-    
-    std::vector<BenchmarkConfig> configs = {
-        {"Single-thread, Sync, No Dedup", false, false, 1000, 1},
-        {"Single-thread, Async, No Dedup", true, false, 1000, 1},
-        {"Single-thread, Async, With Dedup", true, true, 1000, 1},
-        {"Multi-thread (4), Async, No Dedup", true, false, 1000, 4},
-        {"Multi-thread (8), Async, No Dedup", true, false, 1000, 8},
-        {"Large Buffer (10k), Async", true, false, 10000, 1},
-    };
-    
-    const int messagesPerThread = 10000;
+// Test 15: Per-thread Ring Frontend
+void testPerThreadRings(TestHarness& harness) {
+    harness.startTest("Per-thread Ring Frontend");
     
-    for (const auto& benchConfig : configs) {
-        std::cout << "\nBenchmark: " << benchConfig.name << std::endl;
+    try {
+        BufferedLogger::Config config;
+        config.outputFile = "test_rings.log";
+        config.consoleOutput = false;
+        config.asyncFlush = true;
+        config.enableDeduplication = false;
+        config.queueType = QueueType::PerThreadRing;
+        config.threadRingCapacity = 64;  // Small ring to exercise the full-ring fallback
+        config.flushInterval = 10ms;
+        
+        BufferedLogger logger(config);
+        
+        const int numThreads = 8;
+        const int logsPerThread = 1000;
+        
+        // Short-lived producers: rings must be drained after their threads exit
+        for (int round = 0; round < 3; round++) {
+            std::vector<std::thread> threads;
+            for (int t = 0; t < numThreads; t++) {
+                threads.emplace_back([&logger, t, logsPerThread]() {
+                    for (int i = 0; i < logsPerThread; i++) {
+                        logger.info("Ring thread " + std::to_string(t) + " msg " + std::to_string(i));
+                    }
+                });
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+        }
+        
+        logger.forceFlush();
+        
+        auto stats = logger.getStats();
+        const size_t expected = 3 * numThreads * logsPerThread;
+        harness.assertCondition(stats.totalLogged == expected, "All messages should be logged");
+        harness.assertCondition(stats.totalFlushed == expected, "All ring entries should be flushed");
+        harness.assertCondition(stats.currentBufferSize == 0, "Nothing should remain buffered");
         
+        harness.endTest(true);
+    } catch (const std::exception& e) {
+        harness.endTest(false, e.what());
+    }
+}
+
+// Test 16: Bounded MPSC Queue Frontend
+void testMpscQueue(TestHarness& harness) {
+    harness.startTest("Bounded MPSC Queue Frontend");
+    
+    try {
         BufferedLogger::Config config;
-        config.outputFile = "benchmark.log";
+        config.outputFile = "test_mpsc.log";
         config.consoleOutput = false;
-        config.asyncFlush = benchConfig.asyncFlush;
-        config.enableDeduplication = benchConfig.deduplication;
-        config.bufferSize = benchConfig.bufferSize;
+        config.asyncFlush = true;
+        config.enableDeduplication = false;
+        config.queueType = QueueType::BoundedMpsc;
+        config.mpscQueueCapacity = 128;  // Small queue to exercise the full-queue fallback
+        config.flushInterval = 10ms;
         
         BufferedLogger logger(config);
         
-        auto start = std::chrono::high_resolution_clock::now();
+        const int numThreads = 16;
+        const int logsPerThread = 500;
         
         std::vector<std::thread> threads;
-        for (int t = 0; t < benchConfig.numThreads; t++) {
-            threads.emplace_back([&logger, messagesPerThread, t]() {
-                for (int i = 0; i < messagesPerThread; i++) {
-                    logger.info("Thread " + std::to_string(t) + " msg " + std::to_string(i));
+        for (int t = 0; t < numThreads; t++) {
+            threads.emplace_back([&logger, t, logsPerThread]() {
+                for (int i = 0; i < logsPerThread; i++) {
+                    logger.info("MPSC thread " + std::to_string(t) + " msg " + std::to_string(i));
                 }
             });
         }
+        for (auto& thread : threads) {
+            thread.join();
+        }
         
-        for (auto& t : threads) {
-            t.join();
+        logger.forceFlush();
+        
+        auto stats = logger.getStats();
+        const size_t expected = numThreads * logsPerThread;
+        harness.assertCondition(stats.totalLogged == expected, "All messages should be logged");
+        harness.assertCondition(stats.totalFlushed == expected, "All queued entries should be flushed");
+        harness.assertCondition(stats.currentBufferSize == 0, "Nothing should remain buffered");
+        
+        harness.endTest(true);
+    } catch (const std::exception& e) {
+        harness.endTest(false, e.what());
+    }
+}
+
+// Test 17: Deferred Formatting
+void testDeferredFormatting(TestHarness& harness) {
+    harness.startTest("Deferred Formatting");
+    
+    try {
+        BufferedLogger::Config config;
+        config.outputFile = "test_deferred.log";
+        config.consoleOutput = false;
+        config.asyncFlush = false;
+        config.enableDeduplication = false;
+        
+        std::remove(config.outputFile.c_str());
+        BufferedLogger logger(config);
+        
+        std::vector<std::string> rendered;
+        logger.setFlushCallback([&rendered](const std::vector<LogEntry>& entries) {
+            for (const auto& entry : entries) {
+                rendered.push_back(entry.message.str());
+            }
+        });
+        
+        // Caller-owned buffer is overwritten right after the call
+        char scratch[32];
+        std::snprintf(scratch, sizeof(scratch), "%s", "surface-0");
+        logger.log(LogLevel::INFO, "Present %s frame=%u pts=%.3f", scratch, 7u, 1.5);
+        std::snprintf(scratch, sizeof(scratch), "%s", "clobbered");
+        
+        std::string owned = "vram-heap";
+        logger.log(LogLevel::INFO, "Heap %s: %zu bytes, %lld total", owned, size_t(4096), -1LL);
+        
+        // Longer than the old 4096-byte thread-local format buffer
+        std::string longArg(6000, 'Z');
+        logger.log(LogLevel::INFO, "Long: %s!", longArg);
+        
+        const char* missing = nullptr;
+        logger.log(LogLevel::INFO, "Name: %s", missing);
+        
+        // A format built at run time is copied like the arguments
+        {
+            std::string format = std::string("Runtime ") + "%d of %s";
+            logger.log(LogLevel::INFO, format.c_str(), 3, "formats");
+            format.assign(format.size(), 'X');
+        }
+        
+        // Site formats are checked against their arguments at compile time
+        using detail::formatArgList;
+        using detail::formatMatches;
+        static_assert(formatMatches("%d %u %c", decltype(formatArgList(1, 2u, 'c')){}), "promoted integers");
+        static_assert(formatMatches("%zu %lld %5.2f %s %s", decltype(formatArgList(size_t(1), 1LL, 1.0f, "a",
+                                                                                  std::string())){}),
+                      "sizes, floats and strings");
+        static_assert(formatMatches("%*d%% %p", decltype(formatArgList(4, 2, &config)){}), "star width and %p");
+        static_assert(!formatMatches("%d", decltype(formatArgList(1.0)){}), "double for %d");
+        static_assert(!formatMatches("%d", decltype(formatArgList(size_t(1))){}), "size_t for %d");
+        static_assert(!formatMatches("%s", decltype(formatArgList(1)){}), "int for %s");
+        static_assert(!formatMatches("%d %d", decltype(formatArgList(1)){}), "missing argument");
+        static_assert(!formatMatches("%d", decltype(formatArgList(1, 2)){}), "extra argument");
+        
+        // Without arguments a dynamic string is copied, not kept as a format
+        {
+            std::string temporary = "Temporary text " + std::to_string(42) + std::string(200, '.');
+            logger.log(LogLevel::INFO, temporary.c_str());
+            logger.category("display").log(LogLevel::INFO, temporary.c_str());
+            temporary.assign(temporary.size(), 'X');
         }
         
         logger.forceFlush();
         
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+        harness.assertCondition(rendered.size() == 7, "All deferred entries should be flushed");
+        harness.assertCondition(rendered[0] == "Present surface-0 frame=7 pts=1.500",
+                              "String argument should be captured at log time");
+        harness.assertCondition(rendered[1] == "Heap vram-heap: 4096 bytes, -1 total",
+                              "std::string and integer arguments should format");
+        harness.assertCondition(rendered[2].size() == 6000 + 7, "Long messages should not be truncated");
+        harness.assertCondition(rendered[3] == "Name: (null)", "A null string argument should print as (null)");
+        harness.assertCondition(rendered[4] == "Runtime 3 of formats", "A runtime format should be copied");
+        harness.assertCondition(rendered[5].rfind("Temporary text 42...", 0) == 0 && rendered[5].size() == 217 &&
+                                rendered[6] == rendered[5],
+                              "Text without arguments should be copied at log time");
         
-        int totalMessages = messagesPerThread * benchConfig.numThreads;
-        double throughput = (totalMessages * 1000000.0) / duration.count();
-        double latency = duration.count() / (double)totalMessages;
+        harness.endTest(true);
+    } catch (const std::exception& e) {
+        harness.endTest(false, e.what());
+    }
+}
+
+// Test 18: Log Site Registry
+void testLogSiteRegistry(TestHarness& harness) {
+    harness.startTest("Log Site Registry");
+    
+    try {
+        BufferedLogger::Config config;
+        config.outputFile = "test_sites.log";
+        config.consoleOutput = false;
+        config.asyncFlush = false;
+        config.enableDeduplication = true;
         
-        std::cout << "  Total messages: " << totalMessages << std::endl;
-        std::cout << "  Duration: " << duration.count() / 1000.0 << " ms" << std::endl;
-        std::cout << "  Throughput: " << std::fixed << std::setprecision(0) 
-                  << throughput << " msgs/sec" << std::endl;
-        std::cout << "  Avg latency: " << std::fixed << std::setprecision(2) 
-                  << latency << " μs/msg" << std::endl;
+        BufferedLogger logger(config);
         
-        auto stats = logger.getStats();
-        std::cout << "  Total flushes: " << stats.totalFlushes << std::endl;
-        if (benchConfig.deduplication) {
-            std::cout << "  Deduplicated: " << stats.totalDeduplicated << std::endl;
+        std::vector<LogEntry> flushed;
+        logger.setFlushCallback([&flushed](const std::vector<LogEntry>& entries) {
+            flushed.insert(flushed.end(), entries.begin(), entries.end());
+        });
+        
+        size_t sitesBefore = LogSiteRegistry::instance().size();
+        int evaluated = 0;
+        auto countedArg = [&evaluated](int value) { evaluated++; return value; };
+        
+        size_t disabled = 0;
+        for (int i = 0; i < 4; i++) {
+            if (i == 3) {
+                // Disable every site in this file; arguments must not be evaluated
+                disabled = LogSiteRegistry::instance().setEnabled("test_buffered_logger.cpp", 0, false);
+            }
+            DRIVER_LOG_SITE(logger, LogLevel::INFO, "VSYNC interrupt");
+            DRIVER_LOG_SITE(logger, LogLevel::WARNING, "Frame %d late by %dms", countedArg(i), 3);
+        }
+        LogSiteRegistry::instance().setEnabled("test_buffered_logger.cpp", 0, true);
+        
+        harness.assertCondition(LogSiteRegistry::instance().size() == sitesBefore + 2,
+                              "Each call site should register exactly once");
+        harness.assertCondition(disabled >= 2, "Sites should be found by file name");
+        
+        logger.forceFlush();
+        
+        harness.assertCondition(evaluated == 3, "Disabled site should skip argument evaluation");
+        // Constant site deduplicates to a single record, formatted site keeps all three
+        harness.assertCondition(flushed.size() == 4, "Expected 1 constant + 3 formatted records");
+        harness.assertCondition(flushed[0].message == "VSYNC interrupt", "Constant site should render its format");
+        harness.assertCondition(flushed[1].message == "Frame 0 late by 3ms", "Arguments should render on flush");
+        
+        const LogSite* site = LogSiteRegistry::instance().find(flushed[1].siteId);
+        harness.assertCondition(site && site->level() == LogLevel::WARNING && site->line() > 0,
+                              "Records should resolve back to their site");
+        harness.assertCondition(sizeof(SiteRecord) * 3 <= sizeof(LogEntry),
+                              "Site records should be a fraction of an entry slot");
+        
+        harness.endTest(true);
+    } catch (const std::exception& e) {
+        harness.endTest(false, e.what());
+    }
+}
+
+// Test 19: Allocation-free Hot Path
+void testAllocationFreeLogging(TestHarness& harness) {
+    harness.startTest("Allocation-free Hot Path");
+    
+    try {
+        for (QueueType queueType : {QueueType::SharedBuffer, QueueType::PerThreadRing}) {
+            BufferedLogger::Config config;
+            config.outputFile = "test_alloc.log";
+            config.consoleOutput = false;
+            config.asyncFlush = true;
+            config.enableDeduplication = false;
+            config.bufferSize = 100000;
+            config.queueType = queueType;
+            config.flushInterval = 10000ms;  // No flush during the measurement
+            
+            BufferedLogger logger(config);
+            
+            // Warm-up registers the thread ring and this thread's arena chunk
+            logger.info("warm-up");
+            logger.log(LogLevel::INFO, "warm-up %d", 0);
+            
+            const std::string typical =
+                "Processing command: DRAW_INDEXED [size: 65536 bytes] on queue 3 (fence 1234567)";
+            
+            t_allocationCount = 0;
+            for (int i = 0; i <= 200; i++) {
+                // First pass registers the log site
+                t_countAllocations = i > 0;
+                logger.info("VSYNC interrupt received");
+                logger.debug(typical);
+                logger.log(LogLevel::INFO, "Performance: FPS=%d, GPU=%d%%, VRAM=%d%%", 60, i % 100, 75);
+                DRIVER_LOG_SITE(logger, LogLevel::WARNING, "Frame %d late by %dms", i, 3);
+            }
+            t_countAllocations = false;
+            size_t typicalAllocations = t_allocationCount;
+            
+            // Long messages amortize over shared arena chunks
+            const std::string longMessage(1000, 'L');
+            t_allocationCount = 0;
+            t_countAllocations = true;
+            for (int i = 0; i < 200; i++) {
+                logger.info(longMessage);
+            }
+            t_countAllocations = false;
+            size_t longAllocations = t_allocationCount;
+            
+            logger.forceFlush();
+            
+            harness.assertCondition(typicalAllocations == 0,
+                                  "Typical messages should not allocate (got " +
+                                  std::to_string(typicalAllocations) + ")");
+            harness.assertCondition(longAllocations <= 200 * 1000 / MessageArena::kChunkSize + 1,
+                                  "Long messages should share arena chunks (got " +
+                                  std::to_string(longAllocations) + ")");
+            harness.assertCondition(logger.getStats().totalFlushed == 1006, "All messages should be flushed");
+        }
+        
+        harness.endTest(true);
+    } catch (const std::exception& e) {
+        harness.endTest(false, e.what());
+    }
+}
+
+// Test 20: Generation Arena Reset
+void testGenerationArena(TestHarness& harness) {
+    harness.startTest("Generation Arena Reset");
+    
+    try {
+        const size_t payloadSize = 500;  // Beyond inline capacity, lands in the arena
+        
+        BufferedLogger::Config config;
+        config.outputFile = "test_arena.log";
+        config.consoleOutput = false;
+        config.asyncFlush = false;
+        config.enableDeduplication = false;
+        config.maxMemoryBytes = 10 * (sizeof(LogEntry) + payloadSize);
+        
+        BufferedLogger logger(config);
+        
+        std::vector<LogEntry> kept;
+        logger.setFlushCallback([&kept](const std::vector<LogEntry>& entries) {
+            kept.push_back(entries.front());  // Copies must survive the arena reset
+        });
+        
+        auto payload = [payloadSize](int i) { return std::string(payloadSize, static_cast<char>('a' + i)); };
+        
+        for (int i = 0; i < 9; i++) {
+            logger.info(payload(i));
+        }
+        harness.assertCondition(logger.getStats().totalFlushes == 0, "Should stay below the byte limit");
+        
+        logger.info(payload(9));
+        harness.assertCondition(logger.getStats().totalFlushes == 1,
+                              "Should flush exactly when the byte limit is reached");
+        
+        // Second generation reuses the rewound arena
+        for (int i = 10; i < 20; i++) {
+            logger.info(payload(i));
+        }
+        logger.forceFlush();
+        
+        harness.assertCondition(kept.size() == 2, "Expected one callback per generation");
+        harness.assertCondition(kept[0].message == payload(0), "First generation copy should be intact");
+        harness.assertCondition(kept[1].message == payload(10), "Second generation should not see stale bytes");
+        harness.assertCondition(!kept[0].message.isInline(), "Long payloads should be stored out of line");
+        
+        harness.endTest(true);
+    } catch (const std::exception& e) {
+        harness.endTest(false, e.what());
+    }
+}
+
+// Test 21: Buffered Byte Accounting
+void testBufferedByteAccounting(TestHarness& harness) {
+    harness.startTest("Buffered Byte Accounting");
+    
+    try {
+        for (QueueType queueType : {QueueType::SharedBuffer, QueueType::PerThreadRing, QueueType::BoundedMpsc}) {
+            BufferedLogger::Config config;
+            config.outputFile = "test_bytes.log";
+            config.consoleOutput = false;
+            config.asyncFlush = true;
+            config.enableDeduplication = false;
+            config.queueType = queueType;
+            config.flushInterval = 10000ms;
+            
+            BufferedLogger logger(config);
+            const auto& stats = logger.getStats();
+            
+            logger.info("short");
+            harness.assertCondition(stats.currentBufferedBytes == sizeof(LogEntry),
+                                  "Inline message should cost one entry slot");
+            
+            logger.info(std::string(1000, 'B'));
+            harness.assertCondition(stats.currentBufferedBytes == 2 * sizeof(LogEntry) + 1000,
+                                  "Long message should add its out-of-line bytes");
+            
+            DRIVER_LOG_SITE(logger, LogLevel::INFO, "Frame %d late by %dms", 7, 3);
+            harness.assertCondition(stats.currentBufferedBytes == 2 * sizeof(LogEntry) + 1000 + sizeof(SiteRecord),
+                                  "Site call should cost a compact record, not an entry slot");
+            
+            logger.forceFlush();
+            harness.assertCondition(stats.currentBufferedBytes == 0, "Flush should release all bytes");
+            harness.assertCondition(stats.currentBufferSize == 0, "Flush should release all entries");
+        }
+        
+        // Byte budget triggers a flush on the ring frontend too
+        BufferedLogger::Config config;
+        config.outputFile = "test_bytes.log";
+        config.consoleOutput = false;
+        config.asyncFlush = false;
+        config.enableDeduplication = false;
+        config.queueType = QueueType::PerThreadRing;
+        config.maxMemoryBytes = 4 * sizeof(LogEntry);
+        
+        BufferedLogger logger(config);
+        for (int i = 0; i < 4; i++) {
+            logger.info("Entry " + std::to_string(i));
+        }
+        harness.assertCondition(logger.getStats().totalFlushes == 1, "Ring frontend should honor maxMemoryBytes");
+        
+        harness.endTest(true);
+    } catch (const std::exception& e) {
+        harness.endTest(false, e.what());
+    }
+}
+
+// Test 22: Concurrent Deduplication
+void testConcurrentDeduplication(TestHarness& harness) {
+    harness.startTest("Concurrent Deduplication");
+    
+    try {
+        BufferedLogger::Config config;
+        config.outputFile = "test_dedup_mt.log";
+        config.consoleOutput = false;
+        config.asyncFlush = true;
+        config.enableDeduplication = true;
+        config.deduplicationWindowSize = 64;
+        config.deduplicationTimeWindow = 10000ms;
+        
+        BufferedLogger logger(config);
+        
+        const int numThreads = 8;
+        const int logsPerThread = 2000;
+        const int uniqueMessages = 16;
+        
+        std::vector<std::thread> threads;
+        for (int t = 0; t < numThreads; t++) {
+            threads.emplace_back([&logger, logsPerThread, uniqueMessages]() {
+                for (int i = 0; i < logsPerThread; i++) {
+                    logger.warning("GPU temperature threshold approaching on rail " +
+                                   std::to_string(i % uniqueMessages));
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
         }
+        
+        logger.forceFlush();
+        
+        auto stats = logger.getStats();
+        harness.assertCondition(stats.totalLogged + stats.totalDeduplicated == numThreads * logsPerThread,
+                              "Every call should be either logged or deduplicated");
+        harness.assertCondition(stats.totalLogged >= uniqueMessages, "Each unique message should be logged");
+        // Racing first sightings may let a few extra copies through, never many
+        harness.assertCondition(stats.totalLogged <= uniqueMessages * numThreads,
+                              "Repeats within the window should be suppressed");
+        
+        // Toggling at runtime forgets what was seen
+        logger.enableDeduplication(false);
+        logger.enableDeduplication(true);
+        size_t before = stats.totalLogged;
+        logger.warning("GPU temperature threshold approaching on rail 0");
+        harness.assertCondition(stats.totalLogged == before + 1, "Cleared table should log again");
+        
+        harness.endTest(true);
+    } catch (const std::exception& e) {
+        harness.endTest(false, e.what());
+    }
+}
+
+// Reference byte-at-a-time FNV-1a (the previous dedup hash)
+static uint32_t fnv1a32(const std::string& text) {
+    uint32_t hash = 2166136261u;
+    for (char c : text) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Driver-style messages: fixed templates with varying numeric fields
+static std::vector<std::string> makeDriverCorpus(size_t count) {
+    const char* templates[] = {
+        "Frame %d completed",
+        "Processing command: DRAW_INDEXED [size: %d bytes]",
+        "Allocated %d bytes of VRAM [Total: %d]",
+        "Performance: FPS=%d, GPU=%d%%, VRAM=%d%%",
+        "Screen tearing detected at frame %d",
+        "High VRAM usage: %d%% utilized",
+    };
+    
+    std::mt19937 gen(12345);
+    std::vector<std::string> corpus;
+    corpus.reserve(count);
+    char buffer[256];
+    for (size_t i = 0; i < count; i++) {
+        int a = static_cast<int>(i);
+        int b = static_cast<int>(gen() % 1000000);
+        int c = static_cast<int>(gen() % 100);
+        std::snprintf(buffer, sizeof(buffer), templates[i % 6], a, b, c);
+        corpus.emplace_back(buffer);
+    }
+    
+    // The sequential index makes each message unique
+    std::sort(corpus.begin(), corpus.end());
+    corpus.erase(std::unique(corpus.begin(), corpus.end()), corpus.end());
+    return corpus;
+}
+
+// Test 23: 64-bit Message Hash
+void testMessageHash(TestHarness& harness) {
+    harness.startTest("64-bit Message Hash");
+    
+    try {
+        // Every implementation must agree, for every length and alignment
+        std::mt19937 gen(42);
+        std::vector<char> data(4096 + 64);
+        for (auto& c : data) {
+            c = static_cast<char>(gen());
+        }
+        for (size_t length : {0, 1, 7, 8, 15, 16, 31, 32, 33, 63, 64, 100, 511, 512, 513, 1000, 4096}) {
+            for (size_t offset : {0, 1, 3}) {
+                uint64_t expected = hash64With(HashImpl::Scalar, data.data() + offset, length, 7);
+                for (HashImpl impl : {HashImpl::Sse2, HashImpl::Avx2}) {
+                    harness.assertCondition(hash64With(impl, data.data() + offset, length, 7) == expected,
+                                          std::string(hashImplName(impl)) + " disagrees with scalar at length " +
+                                          std::to_string(length));
+                }
+                harness.assertCondition(hash64(data.data() + offset, length, 7) == expected,
+                                      "Dispatched hash disagrees with scalar");
+            }
+        }
+        
+        // Collision rate over a realistic corpus
+        std::vector<std::string> corpus = makeDriverCorpus(1000000);
+        std::vector<uint64_t> wide;
+        std::vector<uint32_t> narrow;
+        wide.reserve(corpus.size());
+        narrow.reserve(corpus.size());
+        for (const auto& message : corpus) {
+            wide.push_back(hash64(message));
+            narrow.push_back(fnv1a32(message));
+        }
+        std::sort(wide.begin(), wide.end());
+        std::sort(narrow.begin(), narrow.end());
+        size_t wideCollisions = wide.size() - (std::unique(wide.begin(), wide.end()) - wide.begin());
+        size_t narrowCollisions = narrow.size() - (std::unique(narrow.begin(), narrow.end()) - narrow.begin());
+        
+        std::cout << "\n  Corpus: " << corpus.size() << " unique messages, collisions: 64-bit="
+                  << wideCollisions << ", FNV-1a 32-bit=" << narrowCollisions
+                  << " (dispatch: " << hashImplName(activeHashImpl()) << ")";
+        
+        harness.assertCondition(wideCollisions == 0, "64-bit hash should not collide on the corpus");
+        
+        harness.endTest(true);
+    } catch (const std::exception& e) {
+        harness.endTest(false, e.what());
+    }
+}
+
+// Test 24: Compile-time and Runtime Level Checks in Macros
+void testCompileTimeLevels(TestHarness& harness) {
+    harness.startTest("Macro Level Elimination");
+    
+    try {
+        auto& logger = GlobalLogger::getInstance();
+        int evaluated = 0;
+        auto message = [&evaluated](const char* text) { evaluated++; return std::string(text); };
+        
+        // TRACE is below DRIVER_LOG_ACTIVE_LEVEL here: gone even if enabled at runtime
+        logger.setMinimumLevel(LogLevel::TRACE);
+        DRIVER_LOG_TRACE(message("compiled out"));
+        DRIVER_LOGF_TRACE("compiled out %d", (evaluated++, 1));
+        const int tracedOnly = 7;  // Referenced only by compiled-out sites; must not warn as unused
+        DRIVER_LOGF_TRACE("compiled out %d", tracedOnly);
+        DRIVER_LOGF_TRACE("compiled out");
+        harness.assertCondition(evaluated == 0, "Compiled-out sites must not evaluate arguments");
+        
+        // Runtime filtering happens before the argument is built
+        logger.setMinimumLevel(LogLevel::WARNING);
+        DRIVER_LOG_DEBUG(message("filtered"));
+        DRIVER_LOGF_INFO("filtered %d", (evaluated++, 1));
+        harness.assertCondition(evaluated == 0, "Filtered levels must not evaluate arguments");
+        
+        size_t before = logger.getStats().totalLogged;
+        DRIVER_LOG_WARNING(message("100% of frames late"));  // Plain text, not a format string
+        harness.assertCondition(evaluated == 1, "Enabled levels evaluate their argument once");
+        harness.assertCondition(logger.getStats().totalLogged == before + 1, "Enabled level should log");
+        
+        logger.setMinimumLevel(LogLevel::DEBUG);
+        harness.endTest(true);
+    } catch (const std::exception& e) {
+        harness.endTest(false, e.what());
+    }
+}
+
+// Test 25: Hierarchical categories
+void testLogCategories(TestHarness& harness) {
+    harness.startTest("Hierarchical Categories");
+    
+    try {
+        BufferedLogger::Config config;
+        config.outputFile = "test_categories.log";
+        config.consoleOutput = false;
+        config.asyncFlush = false;
+        config.enableDeduplication = false;
+        config.minimumLevel = LogLevel::WARNING;
+        
+        std::vector<LogEntry> flushed;  // Outlives the logger's final flush
+        BufferedLogger logger(config);
+        logger.setFlushCallback([&flushed](const std::vector<LogEntry>& entries) {
+            flushed.insert(flushed.end(), entries.begin(), entries.end());
+        });
+        
+        LogCategory& vsync = logger.category("display.vsync");
+        LogCategory& mem = logger.category("display.mem");
+        LogCategory& display = logger.category("display");
+        harness.assertCondition(vsync.parent() == &display && mem.parent() == &display,
+                              "Ancestors should be created on first use");
+        harness.assertCondition(&logger.category("display.vsync") == &vsync, "Lookups should be stable");
+        
+        // Verbose VSYNC tracing while the memory manager stays at WARNING
+        logger.setCategoryLevel("display.vsync", LogLevel::TRACE);
+        harness.assertCondition(vsync.isEnabled(LogLevel::TRACE), "Configured level should apply");
+        harness.assertCondition(!mem.isEnabled(LogLevel::INFO) && mem.isEnabled(LogLevel::WARNING),
+                              "Unconfigured categories inherit the root level");
+        
+        display.setLevel(LogLevel::DEBUG);
+        harness.assertCondition(mem.level() == LogLevel::DEBUG, "Children inherit the nearest ancestor");
+        harness.assertCondition(vsync.level() == LogLevel::TRACE, "Explicit levels override ancestors");
+        
+        logger.setMinimumLevel(LogLevel::ERROR);
+        harness.assertCondition(mem.level() == LogLevel::DEBUG, "Root changes stop at configured ancestors");
+        display.clearLevel();
+        harness.assertCondition(mem.level() == LogLevel::ERROR && display.level() == LogLevel::ERROR,
+                              "Cleared levels fall back to the root");
+        vsync.clearLevel();
+        harness.assertCondition(!vsync.isEnabled(LogLevel::WARNING), "Cleared levels follow the parent again");
+        
+        vsync.setLevel(LogLevel::TRACE);
+        vsync.trace("vblank 1");
+        vsync.log(LogLevel::DEBUG, "flip pipe=%d", 2);
+        DRIVER_LOG_SITE(vsync, LogLevel::TRACE, "scanline %u", 480u);
+        mem.warning("filtered by root");
+        logger.warning("filtered by root");
+        logger.error("root error");
+        logger.forceFlush();
+        
+        harness.assertCondition(flushed.size() == 4, "Expected 3 vsync records and 1 root record");
+        harness.assertCondition(flushed[0].category == &vsync && flushed[1].message == "flip pipe=2" &&
+                                flushed[2].message == "scanline 480",
+                              "Category records should carry their category");
+        harness.assertCondition(flushed[3].category == nullptr, "Root records have no category");
+        
+        // Level changes race with producers: lookups must stay consistent
+        std::atomic<bool> done{false};
+        std::thread toggler([&]() {
+            for (int i = 0; i < 2000; i++) {
+                logger.setCategoryLevel("display", (i & 1) ? LogLevel::TRACE : LogLevel::CRITICAL);
+            }
+            done = true;
+        });
+        size_t attempts = 0;
+        while (!done) {
+            mem.debug("racing level change");
+            attempts++;
+        }
+        toggler.join();
+        harness.assertCondition(attempts > 0 && logger.getStats().totalLogged <= 4 + attempts,
+                              "Producers should only log what was enabled");
+        
+        harness.endTest(true);
+    } catch (const std::exception& e) {
+        harness.endTest(false, e.what());
+    }
+}
+
+// Test 26: Clock Sources
+void testClockSources(TestHarness& harness) {
+    harness.startTest("Clock Sources");
+    
+    try {
+        for (ClockSource source : {ClockSource::SteadyClock, ClockSource::MonotonicCoarse, ClockSource::Tsc}) {
+            BufferedLogger::Config config;
+            config.outputFile = "test_clock.log";
+            config.consoleOutput = false;
+            config.asyncFlush = false;
+            config.clockSource = source;
+            config.deduplicationTimeWindow = 50ms;
+            
+            std::vector<LogEntry> flushed;
+            BufferedLogger logger(config);
+            logger.setFlushCallback([&flushed](const std::vector<LogEntry>& entries) {
+                flushed.insert(flushed.end(), entries.begin(), entries.end());
+            });
+            
+            auto before = std::chrono::steady_clock::now();
+            logger.info("first");
+            std::this_thread::sleep_for(20ms);
+            logger.info("second");
+            logger.info("second");  // Inside the window, measured in this source's ticks
+            auto after = std::chrono::steady_clock::now();
+            std::this_thread::sleep_for(80ms);
+            logger.info("second");  // Window expired
+            logger.forceFlush();
+            
+            std::string name = clockSourceName(source);
+            harness.assertCondition(flushed.size() == 3, name + ": dedup window should follow the clock");
+            
+            // Coarse ticks lag by up to one jiffy; TSC conversion is extrapolated
+            const auto slack = 10ms;
+            harness.assertCondition(flushed[0].timestamp >= before - slack && flushed[1].timestamp <= after + slack,
+                                  name + ": converted timestamps should fall inside the logging window");
+            auto gap = flushed[1].timestamp - flushed[0].timestamp;
+            harness.assertCondition(gap >= 20ms - slack && gap <= 20ms + 4 * slack,
+                                  name + ": tick deltas should convert to elapsed time");
+            harness.assertCondition(flushed[2].timestamp > flushed[1].timestamp,
+                                  name + ": timestamps should be ordered");
+        }
+        
+        harness.endTest(true);
+    } catch (const std::exception& e) {
+        harness.endTest(false, e.what());
+    }
+}
+
+// Test 27: Line Formatting
+void testLineFormatting(TestHarness& harness) {
+    harness.startTest("Line Formatting");
+    
+    try {
+        std::tm local{};
+        local.tm_year = 2024 - 1900;
+        local.tm_mon = 1;
+        local.tm_mday = 29;
+        local.tm_hour = 23;
+        local.tm_min = 59;
+        local.tm_sec = 59;
+        local.tm_isdst = -1;
+        auto second = std::chrono::system_clock::from_time_t(std::mktime(&local));
+        
+        std::ostringstream tid;
+        tid << std::hex << std::this_thread::get_id();
+        
+        LogEntry entry(LogLevel::WARNING, "Pipe A underrun");
+        entry.count = 3;
+        
+        LogLineFormatter formatter;
+        std::string out;
+        formatter.appendLine(out, entry, second + 42ms);
+        harness.assertCondition(out == "[2024-02-29 23:59:59.042] [WARN ] [T:" + tid.str() +
+                                       "] Pipe A underrun (repeated 3 times)\n",
+                              "Milliseconds should come from wall time");
+        
+        // Cached prefix must roll over with the second
+        entry.count = 1;
+        out.clear();
+        formatter.appendLine(out, entry, second + 999ms);
+        formatter.appendLine(out, entry, second + 1000ms);
+        harness.assertCondition(out.find("[2024-02-29 23:59:59.999] [WARN ]") == 0, "Same second reuses the prefix");
+        harness.assertCondition(out.find("\n[2024-03-01 00:00:00.000] [WARN ]") != std::string::npos,
+                              "Next second should re-render the date");
+        harness.assertCondition(out.find("repeated") == std::string::npos, "Single entries have no repeat suffix");
+        
+        harness.endTest(true);
+    } catch (const std::exception& e) {
+        harness.endTest(false, e.what());
+    }
+}
+
+// Test 28: Batched Output
+void testBatchedOutput(TestHarness& harness) {
+    harness.startTest("Batched Output");
+    
+    try {
+        const int numMessages = 10000;
+        for (size_t blockSize : {size_t(64 * 1024), size_t(256)}) {
+            const std::string path = "test_batched.log";
+            std::remove(path.c_str());
+            
+            BufferedLogger::Config config;
+            config.outputFile = path;
+            config.consoleOutput = false;
+            config.asyncFlush = false;
+            config.enableDeduplication = false;
+            config.bufferSize = numMessages + 1;
+            config.outputBlockSize = blockSize;
+            
+            {
+                BufferedLogger logger(config);
+                for (int i = 0; i < numMessages; i++) {
+                    logger.info("Batched line " + std::to_string(i));
+                }
+                logger.forceFlush();
+                
+                std::ifstream file(path, std::ios::binary | std::ios::ate);
+                const size_t bytes = static_cast<size_t>(file.tellg());
+                const size_t blocks = bytes / blockSize + 1;
+                const size_t expected = (blocks + 15) / 16;  // 16 blocks per writev
+                harness.assertCondition(logger.getStats().outputSyscalls <= expected + 1,
+                                      "Flush should take a few writev calls, not one per line");
+            }
+            
+            std::ifstream file(path);
+            std::string line;
+            int lineCount = 0;
+            bool ordered = true;
+            while (std::getline(file, line)) {
+                ordered = ordered && line.size() > 0 &&
+                          line.compare(line.rfind(' ') + 1, std::string::npos, std::to_string(lineCount)) == 0;
+                lineCount++;
+            }
+            harness.assertCondition(lineCount == numMessages && ordered,
+                                  "Every line should be written once, in order");
+        }
+        
+        harness.endTest(true);
+    } catch (const std::exception& e) {
+        harness.endTest(false, e.what());
+    }
+}
+
+// Test 29: io_uring Sink
+void testIoUringSink(TestHarness& harness) {
+    harness.startTest("io_uring Sink");
+    
+    try {
+        const std::string path = "test_uring.log";
+        {
+            std::ofstream existing(path, std::ios::trunc);
+            existing << "existing line\n";
+        }
+        
+        BufferedLogger::Config config;
+        config.outputFile = path;
+        config.consoleOutput = false;
+        config.asyncFlush = false;
+        config.enableDeduplication = false;
+        config.bufferSize = 100000;
+        config.outputBlockSize = 4096;
+        config.fileSinkType = FileSinkType::IoUring;
+        config.ioUringQueueDepth = 4;  // Forces waits for buffers to come back
+        
+        const int numMessages = 50000;
+        {
+            BufferedLogger logger(config);
+            for (int i = 0; i < numMessages; i++) {
+                logger.info("Uring line " + std::to_string(i));
+                if (i % 20000 == 19999) {
+                    logger.forceFlush();
+                }
+            }
+        }
+        std::ifstream file(path);
+        std::string line;
+        std::getline(file, line);
+        harness.assertCondition(line == "existing line", "Writes should start at the end of the file");
+        int lineCount = 0;
+        bool ordered = true;
+        while (std::getline(file, line)) {
+            ordered = ordered && line.compare(line.rfind(' ') + 1, std::string::npos, std::to_string(lineCount)) == 0;
+            lineCount++;
+        }
+        harness.assertCondition(lineCount == numMessages && ordered,
+                              "Out-of-order completions must still produce an ordered file");
+        
+        harness.endTest(true);
+    } catch (const std::exception& e) {
+        harness.endTest(false, e.what());
+    }
+}
+
+// Test 30: O_DIRECT Sink
+void testDirectSink(TestHarness& harness) {
+    harness.startTest("O_DIRECT Sink");
+    
+    try {
+        const std::string path = "test_direct.log";
+        {
+            std::ofstream existing(path, std::ios::trunc);
+            existing << "existing line\n";  // Unaligned tail to resume from
+        }
+        
+        BufferedLogger::Config config;
+        config.outputFile = path;
+        config.consoleOutput = false;
+        config.asyncFlush = false;
+        config.enableDeduplication = false;
+        config.bufferSize = 100000;
+        config.fileSinkType = FileSinkType::Direct;
+        
+        auto fileSize = [&path]() {
+            struct stat st;
+            return stat(path.c_str(), &st) == 0 ? static_cast<size_t>(st.st_size) : 0;
+        };
+        
+        const int numMessages = 30000;
+        {
+            BufferedLogger logger(config);
+            for (int i = 0; i < numMessages; i++) {
+                logger.info("Direct line " + std::to_string(i));
+                if (i == 10) {
+                    // Padding must not be visible between flushes
+                    logger.forceFlush();
+                    std::ifstream file(path, std::ios::binary);
+                    std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+                    harness.assertCondition(contents.find('\0') == std::string::npos &&
+                                            contents.size() >= 15 &&
+                                            contents.compare(contents.size() - 15, 15, "Direct line 10\n") == 0,
+                                          "Flushed data should be readable without padding");
+                    harness.assertCondition(logger.getStats().outputBytes == contents.size() - 14,
+                                          "Output bytes should count log data, not padded blocks");
+                }
+            }
+        }
+        
+        std::ifstream file(path);
+        std::string line;
+        std::getline(file, line);
+        harness.assertCondition(line == "existing line", "Existing contents should be preserved");
+        int lineCount = 0;
+        bool ordered = true;
+        size_t bytes = line.size() + 1;
+        while (std::getline(file, line)) {
+            ordered = ordered && line.compare(line.rfind(' ') + 1, std::string::npos, std::to_string(lineCount)) == 0;
+            bytes += line.size() + 1;
+            lineCount++;
+        }
+        harness.assertCondition(lineCount == numMessages && ordered, "Every line should be written once, in order");
+        harness.assertCondition(fileSize() == bytes, "Shutdown should leave the logical file length");
+        
+        harness.endTest(true);
+    } catch (const std::exception& e) {
+        harness.endTest(false, e.what());
+    }
+}
+
+// Test 31: Memory-mapped Sink
+void testMmapSink(TestHarness& harness) {
+    harness.startTest("Memory-mapped Sink");
+    
+    try {
+        const std::string path = "test_mmap.log";
+        {
+            std::ofstream existing(path, std::ios::trunc);
+            existing << "existing line\n";
+        }
+        
+        BufferedLogger::Config config;
+        config.outputFile = path;
+        config.consoleOutput = false;
+        config.asyncFlush = false;
+        config.enableDeduplication = false;
+        config.bufferSize = 100000;
+        config.fileSinkType = FileSinkType::Mmap;
+        config.mmapChunkSize = 256 * 1024;  // Small chunks force several remaps
+        
+        const int numMessages = 60000;
+        {
+            BufferedLogger logger(config);
+            for (int i = 0; i < numMessages; i++) {
+                logger.info("Mapped line " + std::to_string(i));
+                if (i == 5) {
+                    logger.forceFlush();  // Publishes the setup syscalls
+                } else if (i == 10) {
+                    size_t before = logger.getStats().outputSyscalls;
+                    logger.forceFlush();
+                    std::ifstream file(path, std::ios::binary);
+                    std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+                    harness.assertCondition(contents.find("Mapped line 10\n") != std::string::npos,
+                                          "Flushed lines should be visible through the shared mapping");
+                    harness.assertCondition(logger.getStats().outputSyscalls == before,
+                                          "A flush inside the mapped window needs no syscalls");
+                }
+            }
+            logger.forceFlush();
+            
+            // One fallocate + mmap + munmap per chunk
+            size_t chunks = logger.getStats().outputBytes / config.mmapChunkSize + 2;
+            harness.assertCondition(logger.getStats().outputSyscalls <= 3 * chunks,
+                                  "Syscalls should scale with chunks, not flushes");
+        }
+        
+        std::ifstream file(path, std::ios::binary);
+        std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        harness.assertCondition(contents.find('\0') == std::string::npos, "Close should trim preallocated space");
+        
+        std::istringstream lines(contents);
+        std::string line;
+        std::getline(lines, line);
+        harness.assertCondition(line == "existing line", "Existing contents should be preserved");
+        int lineCount = 0;
+        bool ordered = true;
+        while (std::getline(lines, line)) {
+            ordered = ordered && line.compare(line.rfind(' ') + 1, std::string::npos, std::to_string(lineCount)) == 0;
+            lineCount++;
+        }
+        harness.assertCondition(lineCount == numMessages && ordered, "Every line should be written once, in order");
+
+        // A process that died without close() leaves zeroed preallocation
+        // behind; the next one resumes at the end of the data
+        {
+            std::ofstream crashed(path, std::ios::binary | std::ios::trunc);
+            crashed << "before crash\n" << std::string(3 * 4096 - 13, '\0');
+        }
+        {
+            BufferedLogger logger(config);
+            logger.info("after restart");
+        }
+        std::ifstream restarted(path, std::ios::binary);
+        contents.assign(std::istreambuf_iterator<char>(restarted), std::istreambuf_iterator<char>());
+        harness.assertCondition(contents.find('\0') == std::string::npos &&
+                                contents.compare(0, 14, "before crash\n[") == 0 &&
+                                contents.size() - contents.find("after restart\n") == 14,
+                              "Writing should resume after the data, not the zeros");
+
+        harness.endTest(true);
+    } catch (const std::exception& e) {
+        harness.endTest(false, e.what());
+    }
+}
+
+// Test 32: Log Rotation
+void testLogRotation(TestHarness& harness) {
+    harness.startTest("Log Rotation");
+    
+    try {
+        namespace fs = std::filesystem;
+        const fs::path directory = "test_rotation";
+        fs::remove_all(directory);
+        fs::create_directory(directory);
+        
+        BufferedLogger::Config config;
+        config.outputFile = (directory / "driver.log").string();
+        config.consoleOutput = false;
+        config.asyncFlush = false;
+        config.enableDeduplication = false;
+        config.bufferSize = 100000;
+        config.rotation.maxBytes = 64 * 1024;
+        config.rotation.maxFiles = 3;
+        
+        const int numMessages = 20000;
+        {
+            BufferedLogger logger(config);
+            for (int i = 0; i < numMessages; i++) {
+                logger.info("Rotated line " + std::to_string(i));
+                if (i % 500 == 499) {
+                    logger.forceFlush();
+                }
+            }
+            logger.forceFlush();
+            harness.assertCondition(logger.getStats().totalRotations >= 10, "Files should rotate by size");
+        }
+        
+        // Shutdown waits for the background compression and pruning
+        std::vector<std::string> rotated;
+        for (const auto& item : fs::directory_iterator(directory)) {
+            if (item.path().filename() != "driver.log") {
+                rotated.push_back(item.path().string());
+            }
+        }
+        std::sort(rotated.begin(), rotated.end());
+        harness.assertCondition(rotated.size() == 3, "Only maxFiles rotated files should be kept");
+        
+        // Kept files plus the active one hold the newest lines, contiguous and in order
+        std::string contents;
+        for (const auto& path : rotated) {
+#if DRIVER_LOG_ZLIB
+            harness.assertCondition(path.size() > 3 && path.compare(path.size() - 3, 3, ".gz") == 0,
+                                  "Rotated files should be compressed");
+            gzFile input = gzopen(path.c_str(), "rb");
+            char buffer[16384];
+            int read;
+            while (input && (read = gzread(input, buffer, sizeof(buffer))) > 0) {
+                contents.append(buffer, read);
+            }
+            if (input) {
+                gzclose(input);
+            }
+#else
+            // Built without zlib: rotated files are left as plain text
+            std::ifstream input(path, std::ios::binary);
+            contents.append(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+#endif
+        }
+        std::ifstream active(config.outputFile, std::ios::binary);
+        contents.append(std::istreambuf_iterator<char>(active), std::istreambuf_iterator<char>());
+        
+        std::istringstream lines(contents);
+        std::string line;
+        int previous = -1;
+        bool contiguous = true;
+        while (std::getline(lines, line)) {
+            int number = std::stoi(line.substr(line.rfind(' ') + 1));
+            contiguous = contiguous && (previous < 0 || number == previous + 1);
+            previous = number;
+        }
+        harness.assertCondition(contiguous && previous == numMessages - 1,
+                              "No line should be lost or reordered across rotations");
+        
+        fs::remove_all(directory);
+        harness.endTest(true);
+    } catch (const std::exception& e) {
+        harness.endTest(false, e.what());
+    }
+}
+
+// Test 33: Block Compression
+void testBlockCompression(TestHarness& harness) {
+    harness.startTest("Block Compression");
+    
+    try {
+        // Codec round trips, including incompressible and self-overlapping input
+        std::mt19937 gen(7);
+        std::string random(5000, '\0');
+        for (char& c : random) {
+            c = static_cast<char>(gen());
+        }
+        std::string text;
+        for (int i = 0; i < 3000; i++) {
+            text += "[2024-01-01 12:00:00.000] [DEBUG] Processing command: DRAW_INDEXED [size: " +
+                    std::to_string(i * 37 % 65536) + " bytes]\n";
+        }
+        LzCompressor compressor;
+        for (const std::string& input : {std::string(), std::string("abc"), std::string(100000, 'x'), random, text}) {
+            std::vector<char> packed(LzCompressor::bound(input.size()));
+            size_t size = compressor.compress(input.data(), input.size(), packed.data());
+            std::string output(input.size(), '\0');
+            harness.assertCondition(lzDecompress(packed.data(), size, &output[0], output.size()) && output == input,
+                                  "Blocks should round-trip exactly");
+            if (size > 8) {
+                harness.assertCondition(!lzDecompress(packed.data(), size - 8, &output[0], output.size()),
+                                      "Truncated blocks should be rejected");
+            }
+        }
+        std::vector<char> packed(LzCompressor::bound(text.size()));
+        harness.assertCondition(compressor.compress(text.data(), text.size(), packed.data()) < text.size() / 4,
+                              "Repetitive log text should compress well");
+        
+        // Logger output: two sessions append frames to the same file
+        const std::string path = "test_compress.log";
+        std::remove(path.c_str());
+        BufferedLogger::Config config;
+        config.outputFile = path;
+        config.consoleOutput = false;
+        config.asyncFlush = false;
+        config.enableDeduplication = false;
+        config.bufferSize = 100000;
+        config.compressOutput = true;
+        
+        const int numMessages = 20000;
+        for (int session = 0; session < 2; session++) {
+            BufferedLogger logger(config);
+            for (int i = session * numMessages / 2; i < (session + 1) * numMessages / 2; i++) {
+                logger.info("Compressed line " + std::to_string(i));
+                if (i % 3000 == 0) {
+                    logger.forceFlush();
+                }
+            }
+            logger.forceFlush();
+            harness.assertCondition(logger.getStats().outputBytes * 4 < logger.getStats().renderedBytes,
+                                  "Compressed output should be a fraction of the text");
+        }
+        
+        std::FILE* input = std::fopen(path.c_str(), "rb");
+        std::FILE* output = std::tmpfile();
+        harness.assertCondition(input && output && decompressLzFrames(input, output), "Frames should decode");
+        std::string contents(static_cast<size_t>(std::ftell(output)), '\0');
+        std::rewind(output);
+        harness.assertCondition(std::fread(&contents[0], 1, contents.size(), output) == contents.size(),
+                              "Decoded text should read back");
+        std::fclose(input);
+        std::fclose(output);
+        
+        std::istringstream lines(contents);
+        std::string line;
+        int lineCount = 0;
+        bool ordered = true;
+        while (std::getline(lines, line)) {
+            ordered = ordered && line.compare(line.rfind(' ') + 1, std::string::npos, std::to_string(lineCount)) == 0;
+            lineCount++;
+        }
+        harness.assertCondition(lineCount == numMessages && ordered, "Every line should decode once, in order");
+        
+        std::remove(path.c_str());
+        harness.endTest(true);
+    } catch (const std::exception& e) {
+        harness.endTest(false, e.what());
+    }
+}
+
+// Test 34: Binary Output Format
+void testBinaryFormat(TestHarness& harness) {
+    harness.startTest("Binary Output Format");
+    
+    try {
+        const std::string path = "test_binary.log";
+        std::remove(path.c_str());
+        
+        BufferedLogger::Config config;
+        config.outputFile = path;
+        config.consoleOutput = true;  // Text rendering of the same entries, for comparison
+        config.asyncFlush = false;
+        config.bufferSize = 100000;
+        config.outputFormat = OutputFormat::Binary;
+        
+        // Capture the console to compare against the decoded file
+        std::ostringstream console;
+        std::streambuf* previous = std::cout.rdbuf(console.rdbuf());
+        size_t rendered = 0;
+        for (ClockSource source : {ClockSource::SteadyClock, ClockSource::Tsc}) {
+            config.clockSource = source;  // Second session appends with its own header
+            BufferedLogger logger(config);
+            auto& category = logger.category("display.vsync");
+            std::vector<std::thread> threads;
+            for (int t = 0; t < 3; t++) {
+                threads.emplace_back([&logger, &category, t] {
+                    for (int i = 0; i < 500; i++) {
+                        logger.info("Thread " + std::to_string(t) + " message " + std::to_string(i));
+                        category.log(LogLevel::DEBUG, "Vblank %d on pipe %d", i, t);
+                    }
+                });
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+            logger.forceFlush();
+            for (int i = 0; i < 50; i++) {
+                logger.warning("Repeated warning");
+            }
+            logger.info("");
+            logger.forceFlush();
+            rendered += logger.getStats().renderedBytes;
+        }
+        std::cout.rdbuf(previous);
+        
+        std::FILE* input = std::fopen(path.c_str(), "rb");
+        std::FILE* output = std::tmpfile();
+        harness.assertCondition(input && output && decodeBinaryLog(input, output), "Binary log should decode");
+        std::string decoded(static_cast<size_t>(std::ftell(output)), '\0');
+        std::rewind(output);
+        harness.assertCondition(std::fread(&decoded[0], 1, decoded.size(), output) == decoded.size(),
+                              "Decoded text should read back");
+        std::fclose(output);
+        
+        harness.assertCondition(decoded == console.str(), "Decoded text should match the text format exactly");
+        harness.assertCondition(decoded.find("[display.vsync] Vblank 499 on pipe 2") != std::string::npos,
+                              "Category names should survive");
+        harness.assertCondition(rendered < decoded.size(), "Records should be smaller than the text");
+        
+        // A truncated file decodes up to the damage and reports it
+        std::fseek(input, 0, SEEK_END);
+        long size = std::ftell(input);
+        std::fclose(input);
+        ::truncate(path.c_str(), size - 3);
+        input = std::fopen(path.c_str(), "rb");
+        output = std::tmpfile();
+        harness.assertCondition(!decodeBinaryLog(input, output), "Truncation should be reported");
+        harness.assertCondition(std::ftell(output) > 0, "Records before the damage should still decode");
+        std::fclose(input);
+        std::fclose(output);
+        
+        std::remove(path.c_str());
+        harness.endTest(true);
+    } catch (const std::exception& e) {
+        harness.endTest(false, e.what());
+    }
+}
+
+// Test 35: Flight Recorder
+void testFlightRecorder(TestHarness& harness) {
+    harness.startTest("Flight Recorder");
+    
+    try {
+        const std::string logPath = "test_flight.log";
+        const std::string ringPath = "test_flight.ring";
+        std::remove(logPath.c_str());
+        std::remove(ringPath.c_str());
+        std::remove((ringPath + ".prev").c_str());
+        
+        BufferedLogger::Config config;
+        config.outputFile = logPath;
+        config.consoleOutput = false;
+        config.enableDeduplication = false;
+        config.bufferSize = 100000;
+        config.flushInterval = std::chrono::milliseconds(60000);
+        config.flightRecorderFile = ringPath;
+        config.flightRecorderEntries = 256;
+        
+        // The child dies with everything still buffered
+        pid_t child = fork();
+        if (child == 0) {
+            BufferedLogger logger(config);
+            for (int i = 0; i < 1000; i++) {
+                logger.info("Crash line " + std::to_string(i));
+            }
+            logger.category("display.pipe").log(LogLevel::ERROR, "Pipe %d underrun", 2);
+            DRIVER_LOG_SITE(logger, LogLevel::WARNING, "Plane %s at %5.1f%%", "cursor", 12.5);
+            logger.critical(std::string(1000, 'x'));  // Longer than a slot
+            kill(getpid(), SIGKILL);
+        }
+        int status = 0;
+        waitpid(child, &status, 0);
+        harness.assertCondition(WIFSIGNALED(status), "Child should have been killed");
+        
+        std::ifstream lost(logPath);
+        std::string unflushed((std::istreambuf_iterator<char>(lost)), std::istreambuf_iterator<char>());
+        harness.assertCondition(unflushed.find("Crash line") == std::string::npos,
+                              "The buffered entries never reached the log file");
+        
+        auto dump = [&](const std::string& path, size_t entries) {
+            std::FILE* output = std::tmpfile();
+            bool ok = dumpFlightRecorder(path, entries, output);
+            std::string text(static_cast<size_t>(std::ftell(output)), '\0');
+            std::rewind(output);
+            ok = ok && std::fread(&text[0], 1, text.size(), output) == text.size();
+            std::fclose(output);
+            return ok ? text : std::string();
+        };
+        
+        std::string recovered = dump(ringPath, 100);
+        std::istringstream lines(recovered);
+        std::vector<std::string> recoveredLines;
+        for (std::string line; std::getline(lines, line);) {
+            recoveredLines.push_back(line);
+        }
+        harness.assertCondition(recoveredLines.size() == 100, "The last N entries should be recovered");
+        harness.assertCondition(recoveredLines[0].find("Crash line 903") != std::string::npos &&
+                                recoveredLines[96].find("Crash line 999") != std::string::npos,
+                              "Recovered entries should be the newest, in order");
+        auto endsWith = [](const std::string& line, const std::string& suffix) {
+            return line.size() >= suffix.size() &&
+                   line.compare(line.size() - suffix.size(), suffix.size(), suffix) == 0;
+        };
+        harness.assertCondition(recoveredLines[97].find("[ERROR] [T:") != std::string::npos &&
+                                endsWith(recoveredLines[97], "] [display.pipe] Pipe 2 underrun"),
+                              "Deferred entries keep level and category and render their arguments");
+        harness.assertCondition(recoveredLines[98].find("[WARN ]") != std::string::npos &&
+                                endsWith(recoveredLines[98], "] Plane cursor at  12.5%"),
+                              "Site entries render their arguments");
+        harness.assertCondition(recoveredLines[99].find("[CRIT ]") != std::string::npos &&
+                                recoveredLines[99].size() < 300, "Long text should be cut to the slot");
+        std::string everything = dump(ringPath, 100000);
+        harness.assertCondition(everything.find("Crash line 746\n") == std::string::npos &&
+                                everything.find("Crash line 747\n") != std::string::npos,
+                              "The ring holds exactly its capacity");
+        
+        // A restart keeps the crashed recording aside
+        {
+            BufferedLogger logger(config);
+            logger.info("After restart");
+        }
+        harness.assertCondition(dump(ringPath + ".prev", 1).find("[CRIT ]") != std::string::npos,
+                              "The previous recording should be kept");
+        harness.assertCondition(dump(ringPath, 10).find("After restart") != std::string::npos,
+                              "The new process records into a fresh ring");
+        
+        // Entries the overflow policy drops never reach the ring
+        {
+            BufferedLogger::Config overflowConfig = config;
+            overflowConfig.overflowPolicy = OverflowPolicy::DropNewest;
+            overflowConfig.maxPendingEntries = 10;
+            BufferedLogger logger(overflowConfig);
+            for (int i = 0; i < 200; i++) {
+                logger.info("Overflow line " + std::to_string(i));
+            }
+            const size_t admitted = logger.getStats().totalLogged;
+            harness.assertCondition(admitted + logger.getStats().totalDropped == 200, "Every line is kept or dropped");
+            
+            std::string ring = dump(ringPath, 1000);
+            size_t recorded = 0;
+            for (size_t at = ring.find("Overflow line "); at != std::string::npos;
+                 at = ring.find("Overflow line ", at + 1)) {
+                recorded++;
+            }
+            harness.assertCondition(recorded == admitted, "Only admitted entries should be recorded");
+        }
+        
+        std::remove(logPath.c_str());
+        std::remove(ringPath.c_str());
+        std::remove((ringPath + ".prev").c_str());
+        harness.endTest(true);
+    } catch (const std::exception& e) {
+        harness.endTest(false, e.what());
+    }
+}
+
+// Test 36: Emergency Flush
+void testEmergencyFlush(TestHarness& harness) {
+    harness.startTest("Emergency Flush");
+    
+    try {
+        struct Case {
+            QueueType queueType;
+            int signal;
+        };
+        const Case cases[] = {
+            {QueueType::SharedBuffer, SIGSEGV},
+            {QueueType::PerThreadRing, SIGABRT},
+            {QueueType::BoundedMpsc, SIGBUS},
+        };
+        
+        for (const auto& c : cases) {
+            const std::string logPath = "test_emergency.log";
+            std::remove(logPath.c_str());
+            
+            BufferedLogger::Config config;
+            config.outputFile = logPath;
+            config.consoleOutput = false;
+            config.enableDeduplication = false;
+            config.bufferSize = 100000;
+            config.flushInterval = std::chrono::milliseconds(60000);
+            config.queueType = c.queueType;
+            config.threadRingCapacity = 65536;  // Far from the half-full flush trigger
+            config.mpscQueueCapacity = 65536;
+            config.emergencyFlushOnCrash = true;
+            
+            // The child dies with everything still buffered, while another
+            // producer is logging; nothing here can trigger a normal flush
+            pid_t child = fork();
+            if (child == 0) {
+                BufferedLogger logger(config);
+                for (int i = 0; i < 500; i++) {
+                    logger.info("Crash line " + std::to_string(i));
+                }
+                logger.category("display.pipe").log(LogLevel::ERROR, "Pipe %d underrun", 2);
+                DRIVER_LOG_SITE(logger, LogLevel::WARNING, "Plane %s at %5.1f%%", "cursor", 12.5);
+                std::atomic<bool> started{false};
+                std::thread noise([&] {
+                    for (int i = 0; i < 1000; i++) {
+                        logger.debug("Noise " + std::to_string(i));
+                        started.store(true);
+                    }
+                    for (;;) {
+                        std::this_thread::yield();
+                    }
+                });
+                while (!started.load()) {
+                    std::this_thread::yield();
+                }
+                if (c.signal == SIGABRT) {
+                    std::abort();
+                }
+                raise(c.signal);
+                _exit(0);
+            }
+            int status = 0;
+            waitpid(child, &status, 0);
+            harness.assertCondition(WIFSIGNALED(status) && WTERMSIG(status) == c.signal,
+                                  "Child should still die from the original signal");
+            
+            std::ifstream file(logPath);
+            std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            harness.assertCondition(text.find("*** emergency flush") != std::string::npos,
+                                  "The handler should have written the pending entries");
+            bool allLines = true;
+            for (int i = 0; i < 500; i++) {
+                allLines = allLines && text.find("] Crash line " + std::to_string(i) + "\n") != std::string::npos;
+            }
+            harness.assertCondition(allLines, "Every buffered entry should reach the file");
+            harness.assertCondition(text.find("[INFO ] [T:") != std::string::npos,
+                                  "Lines should use the text format");
+            harness.assertCondition(text.find("[display.pipe] Pipe 2 underrun\n") != std::string::npos,
+                                  "Deferred entries keep category and render their arguments");
+            harness.assertCondition(text.find("] Plane cursor at  12.5%\n") != std::string::npos,
+                                  "Site records render their arguments");
+            std::remove(logPath.c_str());
+        }
+        
+        // A crash while a flush is stuck writing: the generation it retired
+        // has not reached the file, and the handler writes it instead. The
+        // output is a FIFO the parent stops reading, so the flush blocks
+        // with most of its entries unwritten.
+        {
+            const std::string fifoPath = "test_emergency.fifo";
+            std::remove(fifoPath.c_str());
+            harness.assertCondition(mkfifo(fifoPath.c_str(), 0600) == 0, "FIFO should be created");
+            const int lineCount = 20000;
+            pid_t child = fork();
+            if (child == 0) {
+                BufferedLogger::Config config;
+                config.outputFile = fifoPath;
+                config.enableDeduplication = false;
+                config.bufferSize = 100000;
+                config.flushInterval = std::chrono::milliseconds(60000);
+                config.emergencyFlushOnCrash = true;
+                BufferedLogger logger(config);
+                for (int i = 0; i < lineCount; i++) {
+                    logger.info("Crash line " + std::to_string(i));
+                }
+                logger.forceFlush();
+                _exit(0);
+            }
+            const int reader = ::open(fifoPath.c_str(), O_RDONLY | O_CLOEXEC);
+            std::string text(1, '\0');
+            const bool started = reader >= 0 && ::read(reader, &text[0], 1) == 1;
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));  // Pipe full, flush blocked
+            kill(child, SIGSEGV);
+            char chunk[65536];
+            ssize_t n = 0;
+            while (reader >= 0 && (n = ::read(reader, chunk, sizeof(chunk))) > 0) {
+                text.append(chunk, static_cast<size_t>(n));
+            }
+            if (reader >= 0) {
+                ::close(reader);
+            }
+            int status = 0;
+            waitpid(child, &status, 0);
+            std::remove(fifoPath.c_str());
+            
+            std::vector<bool> seen(lineCount, false);
+            const std::string marker = "] Crash line ";
+            for (size_t pos = text.find(marker); pos != std::string::npos; pos = text.find(marker, pos + 1)) {
+                const int line = std::atoi(text.c_str() + pos + marker.size());
+                if (line >= 0 && line < lineCount) {
+                    seen[line] = true;
+                }
+            }
+            harness.assertCondition(started && WIFSIGNALED(status) && WTERMSIG(status) == SIGSEGV,
+                                  "The child should die mid-flush");
+            harness.assertCondition(text.find("*** emergency flush") != std::string::npos &&
+                                        std::find(seen.begin(), seen.end(), false) == seen.end(),
+                                  "Entries the flush had not written should be emitted by the handler");
+        }
+        
+        // A logger that has shut down has nothing left to write
+        pid_t child = fork();
+        if (child == 0) {
+            BufferedLogger::Config config;
+            config.outputFile = "test_emergency.log";
+            config.emergencyFlushOnCrash = true;
+            {
+                BufferedLogger logger(config);
+                logger.info("Flushed normally");
+            }
+            raise(SIGSEGV);
+            _exit(0);
+        }
+        int status = 0;
+        waitpid(child, &status, 0);
+        std::ifstream file("test_emergency.log");
+        std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        harness.assertCondition(WIFSIGNALED(status) && WTERMSIG(status) == SIGSEGV &&
+                                text.find("Flushed normally") != std::string::npos &&
+                                text.find("*** emergency flush") == std::string::npos,
+                              "A shut down logger should not be flushed again");
+        std::remove("test_emergency.log");
+        
+        harness.endTest(true);
+    } catch (const std::exception& e) {
+        harness.endTest(false, e.what());
+    }
+}
+
+// Test 37: Overflow Policies
+void testOverflowPolicies(TestHarness& harness) {
+    harness.startTest("Overflow Policies");
+    
+    try {
+        const std::string logPath = "test_overflow.log";
+        
+        // A flush callback that stalls until released keeps the entries
+        // logged meanwhile pending, so the limits are actually reached. The
+        // stall ends when the producer is done or after `stall`, whichever
+        // comes first; only Block needs the time limit, to be waited out.
+        struct Run {
+            std::string text;
+            size_t logged;
+            size_t dropped;
+            size_t droppedByLevel[kLogLevelCount];
+            size_t droppedByReason[kDropReasonCount];
+            size_t maxPending;
+        };
+        auto run = [&](BufferedLogger::Config config, int messages, std::chrono::milliseconds stall) {
+            std::remove(logPath.c_str());
+            config.outputFile = logPath;
+            config.consoleOutput = false;
+            config.enableDeduplication = false;
+            config.bufferSize = 100;
+            config.maxPendingEntries = 200;
+            config.flushInterval = std::chrono::milliseconds(60000);
+            
+            Run result{};
+            std::atomic<bool> release{false};
+            {
+                BufferedLogger logger(config);
+                logger.setFlushCallback([&](const std::vector<LogEntry>&) {
+                    while (!release) {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    }
+                });
+                std::atomic<bool> producerDone{false};
+                std::thread releaser([&] {
+                    const auto deadline = std::chrono::steady_clock::now() + stall;
+                    while (!producerDone && std::chrono::steady_clock::now() < deadline) {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    }
+                    release = true;
+                });
+                for (int i = 0; i < messages; i++) {
+                    LogLevel level = i % 2 ? LogLevel::ERROR : LogLevel::INFO;
+                    logger.log(level, "Storm " + std::to_string(i));
+                    result.maxPending = std::max(result.maxPending, logger.getStats().currentBufferSize.load());
+                }
+                producerDone = true;
+                releaser.join();
+                logger.forceFlush();
+                
+                const auto& stats = logger.getStats();
+                result.logged = stats.totalLogged;
+                result.dropped = stats.totalDropped;
+                for (size_t i = 0; i < kLogLevelCount; i++) {
+                    result.droppedByLevel[i] = stats.droppedByLevel[i];
+                }
+                for (size_t i = 0; i < kDropReasonCount; i++) {
+                    result.droppedByReason[i] = stats.droppedByReason[i];
+                }
+            }
+            std::ifstream file(logPath);
+            result.text.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            return result;
+        };
+        auto lineCount = [](const std::string& text, const std::string& needle) {
+            size_t count = 0;
+            for (size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1)) {
+                count++;
+            }
+            return count;
+        };
+        auto reportedDrops = [](const std::string& text) {
+            size_t total = 0;
+            const std::string marker = "Overflow: ";
+            for (size_t pos = text.find(marker); pos != std::string::npos; pos = text.find(marker, pos + 1)) {
+                total += std::stoul(text.substr(pos + marker.size()));
+            }
+            return total;
+        };
+        
+        const std::chrono::milliseconds untilLogged = std::chrono::hours(1);
+        
+        BufferedLogger::Config config;
+        config.overflowPolicy = OverflowPolicy::DropNewest;
+        Run newest = run(config, 2000, untilLogged);
+        harness.assertCondition(newest.dropped > 0 && newest.logged + newest.dropped == 2000,
+                              "DropNewest should drop what does not fit");
+        harness.assertCondition(newest.maxPending <= 200, "Pending entries should stay within the limit");
+        harness.assertCondition(newest.droppedByReason[static_cast<size_t>(DropReason::Full)] == newest.dropped &&
+                                newest.droppedByLevel[static_cast<size_t>(LogLevel::INFO)] +
+                                        newest.droppedByLevel[static_cast<size_t>(LogLevel::ERROR)] ==
+                                    newest.dropped,
+                              "Drops should be counted by reason and level");
+        harness.assertCondition(lineCount(newest.text, "] Storm ") == newest.logged &&
+                                newest.text.find("Storm 0\n") != std::string::npos &&
+                                newest.text.find("Storm 1999\n") == std::string::npos,
+                              "The oldest entries should be kept");
+        harness.assertCondition(newest.text.find("[WARN ]") != std::string::npos &&
+                                reportedDrops(newest.text) == newest.dropped,
+                              "A synthetic record should report the drop count");
+        
+        config.overflowPolicy = OverflowPolicy::DropOldest;
+        Run oldest = run(config, 2000, untilLogged);
+        harness.assertCondition(oldest.droppedByReason[static_cast<size_t>(DropReason::Evicted)] > 0 &&
+                                oldest.maxPending <= 200, "DropOldest should evict within the limit");
+        harness.assertCondition(oldest.text.find("Storm 1999\n") != std::string::npos &&
+                                lineCount(oldest.text, "] Storm ") == 2000 - oldest.dropped &&
+                                reportedDrops(oldest.text) == oldest.dropped,
+                              "The newest entries should be kept");
+        
+        config.overflowPolicy = OverflowPolicy::DropBelowLevel;
+        config.overflowKeepLevel = LogLevel::ERROR;
+        Run belowLevel = run(config, 2000, untilLogged);
+        harness.assertCondition(belowLevel.dropped > 0 &&
+                                belowLevel.droppedByLevel[static_cast<size_t>(LogLevel::INFO)] == belowLevel.dropped &&
+                                belowLevel.droppedByReason[static_cast<size_t>(DropReason::BelowLevel)] ==
+                                    belowLevel.dropped,
+                              "DropBelowLevel should only drop low levels");
+        harness.assertCondition(lineCount(belowLevel.text, "[ERROR]") == 1000, "Every ERROR entry should be kept");
+        
+        // Block: a short stall is waited out, a long one times out
+        config.overflowPolicy = OverflowPolicy::Block;
+        config.overflowBlockTimeout = std::chrono::milliseconds(5000);
+        Run blocked = run(config, 1000, std::chrono::milliseconds(50));
+        harness.assertCondition(blocked.dropped == 0 && blocked.logged == 1000 &&
+                                lineCount(blocked.text, "] Storm ") == 1000 && blocked.maxPending <= 200,
+                              "Block should wait for room without dropping");
+        config.overflowBlockTimeout = std::chrono::milliseconds(2);
+        auto start = std::chrono::steady_clock::now();
+        Run timedOut = run(config, 1000, untilLogged);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        harness.assertCondition(timedOut.droppedByReason[static_cast<size_t>(DropReason::Timeout)] > 0 &&
+                                timedOut.logged + timedOut.dropped == 1000,
+                              "Block should drop after the timeout");
+        harness.assertCondition(elapsed < std::chrono::seconds(5),
+                              "Each blocked producer should wait about the timeout");
+        
+        // The byte limit also counts long text not yet copied into the arena
+        {
+            BufferedLogger::Config bytesConfig;
+            bytesConfig.outputFile = logPath;
+            bytesConfig.consoleOutput = false;
+            bytesConfig.enableDeduplication = false;
+            bytesConfig.flushInterval = std::chrono::milliseconds(60000);
+            bytesConfig.overflowPolicy = OverflowPolicy::DropNewest;
+            bytesConfig.maxPendingBytes = 4096;
+            BufferedLogger logger(bytesConfig);
+            logger.info(std::string(10000, 'L'));
+            const auto& stats = logger.getStats();
+            harness.assertCondition(stats.totalDropped == 1 && stats.currentBufferedBytes == 0,
+                                  "A message larger than maxPendingBytes should be dropped, not buffered");
+        }
+        
+        // Rings and queues under a flush running flat out: the pending totals
+        // must never wrap below zero or pass the limits by more than the
+        // one-entry overshoot each producer is allowed
+        for (QueueType queueType : {QueueType::PerThreadRing, QueueType::BoundedMpsc}) {
+            const int producers = 8;
+            BufferedLogger::Config stressConfig;
+            stressConfig.outputFile = logPath;
+            stressConfig.consoleOutput = false;
+            stressConfig.enableDeduplication = false;
+            stressConfig.queueType = queueType;
+            stressConfig.mpscQueueCapacity = 256;
+            stressConfig.bufferSize = 64;
+            stressConfig.flushInterval = std::chrono::milliseconds(1);
+            stressConfig.overflowPolicy = OverflowPolicy::DropNewest;
+            stressConfig.maxPendingEntries = 128;
+            stressConfig.maxPendingBytes = 96 * sizeof(LogEntry);
+            std::remove(logPath.c_str());
+
+            BufferedLogger logger(stressConfig);
+            const auto& stats = logger.getStats();
+            std::atomic<bool> done{false};
+            size_t maxEntries = 0;
+            size_t maxBytes = 0;
+            std::thread sampler([&] {
+                while (!done) {
+                    maxEntries = std::max(maxEntries, stats.currentBufferSize.load());
+                    maxBytes = std::max(maxBytes, stats.currentBufferedBytes.load());
+                }
+            });
+            std::vector<std::thread> threads;
+            for (int t = 0; t < producers; t++) {
+                threads.emplace_back([&logger, t] {
+                    for (int i = 0; i < 5000; i++) {
+                        if (i % 2) {
+                            DRIVER_LOG_SITE(logger, LogLevel::INFO, "Stress %d/%d", t, i);
+                        } else {
+                            logger.log(LogLevel::INFO, "Stress entry");
+                        }
+                    }
+                });
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+            done = true;
+            sampler.join();
+            logger.forceFlush();
+
+            harness.assertCondition(maxEntries <= stressConfig.maxPendingEntries + producers &&
+                                    maxBytes <= stressConfig.maxPendingBytes + producers * sizeof(LogEntry),
+                                  "Pending totals should stay within the limits");
+            harness.assertCondition(stats.totalLogged + stats.totalDropped == producers * 5000 &&
+                                    stats.currentBufferSize == 0 && stats.currentBufferedBytes == 0,
+                                  "Every entry should be counted once and flushed");
+        }
+
+        // Grow (the default) never drops
+        config.overflowPolicy = OverflowPolicy::Grow;
+        Run grown = run(config, 1000, untilLogged);
+        harness.assertCondition(grown.dropped == 0 && grown.logged == 1000 &&
+                                grown.text.find("Overflow:") == std::string::npos,
+                              "Grow should keep everything");
+        
+        std::remove(logPath.c_str());
+        harness.endTest(true);
+    } catch (const std::exception& e) {
+        harness.endTest(false, e.what());
+    }
+}
+
+// Test 38: Rate Limiting
+void testRateLimiting(TestHarness& harness) {
+    harness.startTest("Rate Limiting");
+    
+    try {
+        BufferedLogger::Config config;
+        config.outputFile = "test_ratelimit.log";
+        config.consoleOutput = false;
+        config.asyncFlush = false;
+        config.enableDeduplication = false;
+        
+        BufferedLogger logger(config);
+        std::vector<std::string> messages;
+        logger.setFlushCallback([&messages](const std::vector<LogEntry>& entries) {
+            for (const auto& entry : entries) {
+                messages.emplace_back(entry.message.data(), entry.message.size());
+            }
+        });
+        
+        // Every message is unique, so deduplication could not help here
+        int evaluated = 0;
+        auto countedArg = [&evaluated](int value) { evaluated++; return value; };
+        auto vsyncHandler = [&](int frame) {
+            DRIVER_LOG_SITE_LIMITED(logger, LogLevel::WARNING, 10, 5, "Frame %d took %dms", countedArg(frame), 17);
+        };
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < 1000; i++) {
+            vsyncHandler(i);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        logger.forceFlush();
+        
+        // The site went quiet: the flush itself reports what it suppressed
+        harness.assertCondition(!messages.empty(), "The burst should be flushed");
+        const size_t allowed = messages.size() - 1;
+        harness.assertCondition(allowed >= 5 && allowed <= 5 + static_cast<size_t>(seconds * 10) + 1,
+                              "A burst should be let through, then the refill rate");
+        harness.assertCondition(messages[0] == "Frame 0 took 17ms" && messages[4] == "Frame 4 took 17ms",
+                              "Entries within the limit should be logged normally");
+        harness.assertCondition(logger.getStats().totalRateLimited == 1000 - allowed &&
+                                static_cast<size_t>(evaluated) == allowed,
+                              "Rejected calls should be counted, without evaluating arguments");
+        harness.assertCondition(messages.back().find("Rate limit: suppressed " + std::to_string(1000 - allowed) +
+                                                     " messages from test_buffered_logger.cpp:") == 0,
+                              "A flush should report counts of a quiet site");
+        
+        // Back under the limit: a summary precedes the next entry
+        const size_t limitedBefore = logger.getStats().totalRateLimited;
+        for (int i = 0; i < 20; i++) {
+            vsyncHandler(2000 + i);
+        }
+        const size_t rejected = logger.getStats().totalRateLimited - limitedBefore;
+        std::this_thread::sleep_for(std::chrono::milliseconds(150));
+        vsyncHandler(1000);
+        messages.clear();
+        logger.forceFlush();
+        harness.assertCondition(rejected > 0 && messages.size() >= 2 &&
+                                messages[messages.size() - 2].find("Rate limit: suppressed " +
+                                                                   std::to_string(rejected) + " messages from") == 0 &&
+                                messages.back() == "Frame 1000 took 17ms",
+                              "The suppressed count should be summarized once");
+        
+        // Concurrent callers share one bucket
+        messages.clear();
+        auto& category = logger.category("display.vsync");
+        start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; t++) {
+            threads.emplace_back([&, t] {
+                for (int i = 0; i < 5000; i++) {
+                    DRIVER_LOG_SITE_LIMITED(category, LogLevel::INFO, 1000, 50, "Pipe %d frame %d", t, i);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        logger.forceFlush();
+        size_t logged = 0;
+        size_t reported = 0;
+        const std::string summary = "Rate limit: suppressed ";
+        for (const auto& message : messages) {
+            logged += message.rfind("Pipe ", 0) == 0;
+            if (message.rfind(summary, 0) == 0) {
+                reported += std::stoul(message.substr(summary.size()));
+            }
+        }
+        harness.assertCondition(logged >= 50 && logged <= 50 + static_cast<size_t>(seconds * 1000) + 4,
+                              "Concurrent callers should not exceed the limit");
+        harness.assertCondition(logger.getStats().totalRateLimited == 1000 - allowed + rejected + 20000 - logged,
+                              "Every rejection should be counted once");
+        harness.assertCondition(reported == 20000 - logged, "Every rejection should be reported once");
+        
+        // Tracking belongs to each logger: a later logger reports the same
+        // site's quiet-period counts too
+        auto limitedSite = [](BufferedLogger& target, int frame) {
+            DRIVER_LOG_SITE_LIMITED(target, LogLevel::WARNING, 1, 1, "Scanout %d stalled", frame);
+        };
+        for (int round = 0; round < 2; round++) {
+            BufferedLogger fresh(config);
+            std::vector<std::string> freshMessages;
+            fresh.setFlushCallback([&freshMessages](const std::vector<LogEntry>& entries) {
+                for (const auto& entry : entries) {
+                    freshMessages.emplace_back(entry.message.data(), entry.message.size());
+                }
+            });
+            for (int i = 0; i < 10; i++) {
+                limitedSite(fresh, i);
+            }
+            fresh.forceFlush();
+            const size_t suppressed = fresh.getStats().totalRateLimited;
+            harness.assertCondition(suppressed > 0 && !freshMessages.empty() &&
+                                    freshMessages.back().find("Rate limit: suppressed " + std::to_string(suppressed) +
+                                                              " messages from") == 0,
+                                  "Every logger should report the sites it limited");
+        }
+
+        // Loggers alive at once share the bucket but report only their own rejections
+        {
+            BufferedLogger first(config);
+            BufferedLogger second(config);
+            std::vector<std::string> firstMessages;
+            std::vector<std::string> secondMessages;
+            first.setFlushCallback([&firstMessages](const std::vector<LogEntry>& entries) {
+                for (const auto& entry : entries) {
+                    firstMessages.emplace_back(entry.message.data(), entry.message.size());
+                }
+            });
+            second.setFlushCallback([&secondMessages](const std::vector<LogEntry>& entries) {
+                for (const auto& entry : entries) {
+                    secondMessages.emplace_back(entry.message.data(), entry.message.size());
+                }
+            });
+            for (int i = 0; i < 10; i++) {
+                limitedSite(first, i);
+                if (i < 4) {
+                    limitedSite(second, i);
+                }
+            }
+            first.forceFlush();
+            second.forceFlush();
+            const size_t firstSuppressed = first.getStats().totalRateLimited;
+            const size_t secondSuppressed = second.getStats().totalRateLimited;
+            harness.assertCondition(firstSuppressed >= 9 && secondSuppressed >= 3 && !firstMessages.empty() &&
+                                    !secondMessages.empty() &&
+                                    firstMessages.back().find("Rate limit: suppressed " +
+                                                              std::to_string(firstSuppressed) + " messages") == 0 &&
+                                    secondMessages.back().find("Rate limit: suppressed " +
+                                                               std::to_string(secondSuppressed) + " messages") == 0,
+                                  "Each live logger should report its own rejections of a shared site");
+        }
+
+        logger.shutdown();
+        std::remove("test_ratelimit.log");
+        harness.endTest(true);
+    } catch (const std::exception& e) {
+        harness.endTest(false, e.what());
+    }
+}
+
+// Test 39: Sink Pipeline
+void testSinkPipeline(TestHarness& harness) {
+    harness.startTest("Sink Pipeline");
+    
+    try {
+        const std::string logPath = "test_pipeline.log";
+        std::remove(logPath.c_str());
+        
+        BufferedLogger::Config config;
+        config.outputFile = logPath;
+        config.consoleOutput = false;
+        config.enableDeduplication = false;
+        config.flushInterval = std::chrono::milliseconds(60000);
+        BufferedLogger logger(config);
+        
+        // Inline, WARNING and above
+        std::vector<std::string> errors;
+        SinkOptions errorsOnly;
+        errorsOnly.minimumLevel = LogLevel::WARNING;
+        logger.sinks().add(std::make_unique<CallbackSink>(
+                               [&errors](const LogBatch&, const LogEntry* const* entries, size_t count) {
+                                   for (size_t i = 0; i < count; i++) {
+                                       errors.emplace_back(entries[i]->message.data(), entries[i]->message.size());
+                                   }
+                               }),
+                           errorsOnly);
+        
+        // Own thread and own format
+        std::ostringstream stream;
+        SinkOptions threaded;
+        threaded.dedicatedThread = true;
+        auto shortFormat = [](std::string& out, const LogEntry& entry, std::chrono::system_clock::time_point) {
+            out += entry.level == LogLevel::ERROR ? "E|" : "I|";
+            out += entry.message.view();
+            out += '\n';
+        };
+        const size_t streamSink = logger.sinks().add(std::make_unique<StreamSink>(stream, shortFormat), threaded);
+        
+        // Own thread, stalled until released, with room for two batches
+        std::atomic<bool> release{false};
+        std::atomic<const LogBatch*> firstStalledBatch{nullptr};
+        SinkOptions stalled;
+        stalled.dedicatedThread = true;
+        stalled.maxQueuedBatches = 2;
+        const size_t stalledSink = logger.sinks().add(
+            std::make_unique<CallbackSink>([&](const LogBatch& batch, const LogEntry* const*, size_t) {
+                const LogBatch* expected = nullptr;
+                firstStalledBatch.compare_exchange_strong(expected, &batch);
+                while (!release) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }),
+            stalled);
+        std::atomic<const LogBatch*> firstSharedBatch{nullptr};
+        logger.sinks().add(std::make_unique<CallbackSink>([&](const LogBatch& batch, const LogEntry* const*, size_t) {
+                               const LogBatch* expected = nullptr;
+                               firstSharedBatch.compare_exchange_strong(expected, &batch);
+                           }),
+                           threaded);
+        
+        auto start = std::chrono::steady_clock::now();
+        for (int flush = 0; flush < 10; flush++) {
+            for (int i = 0; i < 10; i++) {
+                const int n = flush * 10 + i;
+                logger.log(n % 2 ? LogLevel::ERROR : LogLevel::INFO, "Pipeline " + std::to_string(n));
+            }
+            logger.forceFlush();
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        
+        std::ifstream file(logPath);
+        std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        harness.assertCondition(text.find("Pipeline 0\n") != std::string::npos &&
+                                text.find("Pipeline 99\n") != std::string::npos && elapsed < std::chrono::seconds(2),
+                              "A stalled sink should not hold up the file");
+        harness.assertCondition(errors.size() == 50 && errors.front() == "Pipeline 1" && errors.back() == "Pipeline 99",
+                              "Inline sinks should see their levels by the end of each flush");
+        
+        const auto& stalledStats = logger.sinks().stats(stalledSink);
+        harness.assertCondition(stalledStats.droppedBatches >= 7 &&
+                                stalledStats.droppedEntries == 10 * stalledStats.droppedBatches,
+                              "The stalled sink should drop batches beyond its queue");
+        harness.assertCondition(!logger.sinks().waitIdle(std::chrono::milliseconds(20)),
+                              "The stalled sink should still be busy");
+        
+        release = true;
+        harness.assertCondition(logger.sinks().waitIdle(std::chrono::milliseconds(5000)),
+                              "Sink threads should catch up");
+        harness.assertCondition(stalledStats.batches + stalledStats.droppedBatches == 10,
+                              "Every batch should be delivered or counted as dropped");
+        harness.assertCondition(firstStalledBatch.load() != nullptr &&
+                                firstStalledBatch.load() == firstSharedBatch.load(),
+                              "Sinks should share one batch per flush");
+        
+        const std::string formatted = stream.str();
+        harness.assertCondition(logger.sinks().stats(streamSink).entries == 100 &&
+                                formatted.rfind("I|Pipeline 0\nE|Pipeline 1\n", 0) == 0 &&
+                                formatted.find("E|Pipeline 99\n") != std::string::npos,
+                              "The threaded sink should get every entry in its own format");
+        
+        logger.shutdown();
+        std::remove(logPath.c_str());
+        harness.endTest(true);
+    } catch (const std::exception& e) {
+        harness.endTest(false, e.what());
+    }
+}
+
+// Hash Microbenchmark
+void runHashBenchmark() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Hash Microbenchmark" << std::endl;
+    std::cout << "========================================" << std::endl;
+    
+    for (size_t length : {16, 64, 256, 4096}) {
+        std::string message(length, 'x');
+        for (size_t i = 0; i < length; i++) {
+            message[i] = static_cast<char>('a' + i % 26);
+        }
+        const size_t iterations = (64 * 1024 * 1024) / length;
+        
+        std::cout << "\nMessage length: " << length << " bytes" << std::endl;
+        
+        auto report = [&](const char* name, auto&& fn) {
+            volatile uint64_t sink = 0;
+            auto start = std::chrono::high_resolution_clock::now();
+            for (size_t i = 0; i < iterations; i++) {
+                message[0] = static_cast<char>(i);  // Defeat hoisting
+                sink = sink + fn(message);
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            double seconds = std::chrono::duration<double>(end - start).count();
+            std::cout << "  " << std::left << std::setw(14) << name << std::right << std::fixed
+                      << std::setprecision(0) << (iterations * length) / seconds / (1024 * 1024) << " MB/s, "
+                      << std::setprecision(1) << seconds * 1e9 / iterations << " ns/hash" << std::endl;
+        };
+        
+        report("fnv1a-32", [](const std::string& m) { return uint64_t(fnv1a32(m)); });
+        report("dispatched", [](const std::string& m) { return hash64(m); });
+        for (HashImpl impl : {HashImpl::Scalar, HashImpl::Sse2, HashImpl::Avx2}) {
+            if (hashImplSupported(impl)) {
+                report(hashImplName(impl), [impl](const std::string& m) {
+                    return hash64With(impl, m.data(), m.size());
+                });
+            }
+        }
+    }
+}
+
+// Performance Benchmark
+void runPerformanceBenchmark(TestHarness& harness) {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Performance Benchmark" << std::endl;
+    std::cout << "========================================" << std::endl;
+    
+    struct BenchmarkConfig {
+        std::string name;
+        bool asyncFlush;
+        bool deduplication;
+        size_t bufferSize;
+        int numThreads;
+        QueueType queueType = QueueType::SharedBuffer;
+    };
+    
+    std::vector<BenchmarkConfig> configs = {
+        {"Single-thread, Sync, No Dedup", false, false, 1000, 1},
+        {"Single-thread, Async, No Dedup", true, false, 1000, 1},
+        {"Single-thread, Async, With Dedup", true, true, 1000, 1},
+        {"Multi-thread (4), Async, No Dedup", true, false, 1000, 4},
+        {"Multi-thread (8), Async, No Dedup", true, false, 1000, 8},
+        {"Multi-thread (4), Async, With Dedup", true, true, 1000, 4},
+        {"Multi-thread (8), Async, With Dedup", true, true, 1000, 8},
+        {"Multi-thread (4), Async, Per-thread Rings", true, false, 1000, 4, QueueType::PerThreadRing},
+        {"Multi-thread (8), Async, Per-thread Rings", true, false, 1000, 8, QueueType::PerThreadRing},
+        {"Single-thread, Async, MPSC Queue", true, false, 1000, 1, QueueType::BoundedMpsc},
+        {"Multi-thread (4), Async, MPSC Queue", true, false, 1000, 4, QueueType::BoundedMpsc},
+        {"Multi-thread (8), Async, MPSC Queue", true, false, 1000, 8, QueueType::BoundedMpsc},
+        {"Large Buffer (10k), Async", true, false, 10000, 1},
+    };
+    
+    const int messagesPerThread = 10000;
+    
+    for (const auto& benchConfig : configs) {
+        std::cout << "\nBenchmark: " << benchConfig.name << std::endl;
+        
+        BufferedLogger::Config config;
+        config.outputFile = "benchmark.log";
+        config.consoleOutput = false;
+        config.asyncFlush = benchConfig.asyncFlush;
+        config.enableDeduplication = benchConfig.deduplication;
+        config.bufferSize = benchConfig.bufferSize;
+        config.queueType = benchConfig.queueType;
+        
+        BufferedLogger logger(config);
+        
+        auto start = std::chrono::high_resolution_clock::now();
+        
+        std::vector<std::thread> threads;
+        for (int t = 0; t < benchConfig.numThreads; t++) {
+            threads.emplace_back([&logger, messagesPerThread, t]() {
+                for (int i = 0; i < messagesPerThread; i++) {
+                    logger.info("Thread " + std::to_string(t) + " msg " + std::to_string(i));
+                }
+            });
+        }
+        
+        for (auto& t : threads) {
+            t.join();
+        }
+        
+        logger.forceFlush();
+        
+        auto end = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+        
+        int totalMessages = messagesPerThread * benchConfig.numThreads;
+        double throughput = (totalMessages * 1000000.0) / duration.count();
+        double latency = duration.count() / (double)totalMessages;
+        
+        std::cout << "  Total messages: " << totalMessages << std::endl;
+        std::cout << "  Duration: " << duration.count() / 1000.0 << " ms" << std::endl;
+        std::cout << "  Throughput: " << std::fixed << std::setprecision(0) 
+                  << throughput << " msgs/sec" << std::endl;
+        std::cout << "  Avg latency: " << std::fixed << std::setprecision(2) 
+                  << latency << " μs/msg" << std::endl;
+        
+        auto stats = logger.getStats();
+        std::cout << "  Total flushes: " << stats.totalFlushes << std::endl;
+        std::cout << "  Output syscalls: " << stats.outputSyscalls << std::endl;
+        // One writev per 16 rendered blocks (default 64 KiB each), per flush;
+        // checked in every build, so a failure ends the run
+        harness.assertCondition(stats.outputSyscalls <= stats.totalFlushes + stats.outputBytes / (16 * 64 * 1024),
+                              benchConfig.name + ": more than one writev per 16 blocks per flush");
+        if (benchConfig.deduplication) {
+            std::cout << "  Deduplicated: " << stats.totalDeduplicated << std::endl;
+        }
+    }
+}
+
+// Line Formatter Benchmark
+void runFormatBenchmark() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Line Formatter Benchmark" << std::endl;
+    std::cout << "========================================" << std::endl;
+    
+    LogEntry entry(LogLevel::INFO, "Frame 1234 presented on pipe A, latency 16ms");
+    const size_t lines = 1000000;
+    const auto base = std::chrono::system_clock::now();
+    
+    // The previous per-line stringstream rendering, for reference
+    auto start = std::chrono::steady_clock::now();
+    size_t bytes = 0;
+    for (size_t i = 0; i < lines; i++) {
+        auto wall = base + std::chrono::microseconds(i * 10);
+        auto timeT = std::chrono::system_clock::to_time_t(wall);
+        std::tm local{};
+        localtime_r(&timeT, &local);
+        std::stringstream ss;
+        ss << "[" << std::put_time(&local, "%Y-%m-%d %H:%M:%S") << "." << std::setfill('0') << std::setw(3)
+           << std::chrono::duration_cast<std::chrono::milliseconds>(wall.time_since_epoch()).count() % 1000
+           << "] [INFO ] [T:" << std::hex << entry.threadId << std::dec << "] " << entry.message;
+        bytes += ss.str().size();
+    }
+    double streamNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / lines;
+    
+    LogLineFormatter formatter;
+    std::string out;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < lines; i++) {
+        formatter.appendLine(out, entry, base + std::chrono::microseconds(i * 10));
+        if (out.size() >= 256 * 1024) {
+            bytes += out.size();
+            out.clear();
+        }
+    }
+    double formatterNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / lines;
+    
+    std::cout << "  stringstream      " << std::fixed << std::setprecision(1) << streamNs << " ns/line" << std::endl;
+    std::cout << "  LogLineFormatter  " << formatterNs << " ns/line" << std::endl;
+    std::cout << "  (" << bytes + out.size() << " bytes rendered)" << std::endl;
+}
+
+// Clock Source Benchmark
+void runClockBenchmark() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Clock Source Benchmark" << std::endl;
+    std::cout << "========================================" << std::endl;
+    
+    if (!tscSupported()) {
+        std::cout << "(no invariant TSC: tsc falls back to steady_clock)" << std::endl;
+    }
+    
+    for (ClockSource source : {ClockSource::SteadyClock, ClockSource::MonotonicCoarse, ClockSource::Tsc}) {
+        ClockCalibration clock(source);
+        const size_t reads = 10000000;
+        volatile uint64_t sink = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < reads; i++) {
+            sink = sink + clock.now();
+        }
+        double readNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / reads;
+        
+        BufferedLogger::Config config;
+        config.outputFile = "benchmark.log";
+        config.consoleOutput = false;
+        config.enableDeduplication = false;
+        config.bufferSize = 10000;
+        config.clockSource = source;
+        
+        const size_t logs = 500000;
+        double logNs;
+        {
+            BufferedLogger logger(config);
+            start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < logs; i++) {
+                logger.info("VSYNC interrupt");
+            }
+            logNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / logs;
+        }
+        
+        std::cout << "  " << std::left << std::setw(18) << clockSourceName(source) << std::right << std::fixed
+                  << std::setprecision(1) << readNs << " ns/read, " << logNs << " ns/log" << std::endl;
+    }
+}
+
+// Bytes of `path` currently resident in the page cache
+size_t pageCacheResidentBytes(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0 || st.st_size == 0) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        return 0;
+    }
+    
+    const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t length = static_cast<size_t>(st.st_size);
+    size_t resident = 0;
+    void* map = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    if (map != MAP_FAILED) {
+        std::vector<unsigned char> pages((length + pageSize - 1) / pageSize);
+        if (mincore(map, length, pages.data()) == 0) {
+            for (unsigned char page : pages) {
+                resident += (page & 1) ? pageSize : 0;
+            }
+        }
+        munmap(map, length);
+    }
+    close(fd);
+    return resident;
+}
+
+// File Sink Benchmark
+void runSinkBenchmark() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "File Sink Benchmark" << std::endl;
+    std::cout << "========================================" << std::endl;
+    
+    // Pre-rendered 64 KiB blocks, so only the output path is measured
+    LogLineFormatter formatter;
+    std::vector<std::string> blocks(1);
+    std::vector<std::string> lines;
+    const auto now = std::chrono::system_clock::now();
+    for (int i = 0; i < 400000; i++) {
+        LogEntry entry(LogLevel::INFO, "Frame " + std::to_string(i) + " presented on pipe A, latency 16ms");
+        std::string line;
+        formatter.appendLine(line, entry, now);
+        lines.push_back(line);
+        blocks.back() += line;
+        if (blocks.back().size() >= 64 * 1024) {
+            blocks.emplace_back();
+        }
+    }
+    std::vector<std::string_view> views(blocks.begin(), blocks.end());
+    const double megabytes = views.size() * 64.0 / 1024;
+    
+    auto report = [megabytes](const char* name, double seconds, size_t syscalls, const std::string& path) {
+        std::cout << "  " << std::left << std::setw(16) << name << std::right << std::fixed << std::setprecision(0)
+                  << megabytes / seconds << " MB/s";
+        if (syscalls > 0) {
+            std::cout << ", " << syscalls << " syscalls";
+        }
+        std::cout << ", " << std::setprecision(1) << pageCacheResidentBytes(path) / (1024.0 * 1024.0)
+                  << " MB in page cache" << std::endl;
+    };
+    
+    for (const std::string dir : {"/dev/shm", "."}) {
+        const std::string path = dir + "/buffered_logger_sink_bench.log";
+        if (!std::ofstream(path)) {
+            continue;
+        }
+        std::cout << "\nDirectory: " << dir << std::endl;
+        
+        std::remove(path.c_str());
+        auto start = std::chrono::steady_clock::now();
+        {
+            std::ofstream stream(path, std::ios::app);
+            for (const auto& line : lines) {
+                stream << std::string_view(line.data(), line.size() - 1) << std::endl;
+            }
+        }
+        report("ofstream+endl", std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), 0,
+               path);
+        
+        for (FileSinkType type : {FileSinkType::Writev, FileSinkType::IoUring, FileSinkType::Direct,
+                                  FileSinkType::Mmap}) {
+            std::remove(path.c_str());
+            FileSinkOptions options;
+            options.type = type;
+            start = std::chrono::steady_clock::now();
+            auto sink = createFileSink(path, options);
+            for (size_t i = 0; i < views.size(); i += 16) {
+                sink->write(views.data() + i, std::min<size_t>(16, views.size() - i));
+                sink->flush();
+            }
+            sink->close();
+            report(sink->name(), std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(),
+                   sink->syscallCount(), path);
+        }
+        std::remove(path.c_str());
+    }
+}
+
+// Rotation Latency Benchmark
+void runRotationBenchmark() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Rotation Latency Benchmark" << std::endl;
+    std::cout << "========================================" << std::endl;
+    
+    // Rotation and compression run on the flush and rotation threads, so the
+    // log() tail should look the same with and without them
+    const int numMessages = 200000;
+    for (bool rotate : {false, true}) {
+        std::filesystem::remove_all("bench_rotation");
+        std::filesystem::create_directory("bench_rotation");
+        
+        BufferedLogger::Config config;
+        config.outputFile = "bench_rotation/driver.log";
+        config.consoleOutput = false;
+        config.enableDeduplication = false;
+        config.bufferSize = 1000;
+        if (rotate) {
+            config.rotation.maxBytes = 1024 * 1024;
+            config.rotation.maxFiles = 4;
+        }
+        
+        std::vector<int64_t> latencies(numMessages);
+        size_t rotations;
+        {
+            BufferedLogger logger(config);
+            for (int i = 0; i < numMessages; i++) {
+                auto start = std::chrono::steady_clock::now();
+                logger.info("Frame " + std::to_string(i) + " presented on pipe A, latency 16ms");
+                latencies[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start).count();
+            }
+            logger.forceFlush();
+            rotations = logger.getStats().totalRotations;
+        }
+        
+        std::sort(latencies.begin(), latencies.end());
+        std::cout << "  " << (rotate ? "Rotating (1 MB, gzip)" : "No rotation") << ": p50 "
+                  << latencies[numMessages / 2] << " ns, p99.9 " << latencies[numMessages * 999 / 1000]
+                  << " ns, max " << latencies.back() << " ns, " << rotations << " rotations" << std::endl;
+    }
+    std::filesystem::remove_all("bench_rotation");
+}
+
+// Compression Benchmark
+void runCompressionBenchmark() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Output Compression Benchmark" << std::endl;
+    std::cout << "========================================" << std::endl;
+    
+    // Replays the message mix of example_usage.cpp's driver simulator (at its
+    // DEBUG level) without the sleeps: command processing dominates, with
+    // performance reports, VRAM pressure and the occasional GPU error
+    std::vector<std::thread::id> threadIds;
+    for (int i = 0; i < 5; i++) {
+        std::thread thread([&threadIds] { threadIds.push_back(std::this_thread::get_id()); });
+        thread.join();
+    }
+    const char* commands[] = {"DRAW_INDEXED", "CLEAR", "PRESENT", "SET_VIEWPORT",
+                              "BIND_PIPELINE", "UPDATE_BUFFER", "COPY_TEXTURE"};
+    const char* errors[] = {"GPU timeout detected", "Invalid command buffer", "Shader compilation failed",
+                            "Surface lost", "Device removed"};
+    std::mt19937 gen(42);
+    
+    LogLineFormatter formatter;
+    std::vector<std::string> blocks(1);
+    auto wallTime = std::chrono::system_clock::now();
+    for (int i = 0; i < 500000; i++) {
+        wallTime += std::chrono::microseconds(gen() % 400);
+        unsigned roll = gen() % 1000;
+        LogEntry entry;
+        if (roll < 900) {
+            entry = LogEntry(LogLevel::DEBUG, "Processing command: " + std::string(commands[i % 7]) +
+                             " [size: " + std::to_string(1024 + gen() % 64512) + " bytes]");
+            entry.threadId = threadIds[1];
+        } else if (roll < 950) {
+            entry = LogEntry(LogLevel::INFO, "Performance: FPS=" + std::to_string(55 + gen() % 11) +
+                             ", GPU=" + std::to_string(40 + gen() % 61) + "%, VRAM=" +
+                             std::to_string(40 + gen() % 61) + "%");
+            entry.threadId = threadIds[4];
+        } else if (roll < 980) {
+            entry = LogEntry(LogLevel::WARNING, "High VRAM usage: " + std::to_string(75 + gen() % 15) + "% utilized");
+            entry.threadId = threadIds[2];
+        } else if (roll < 995) {
+            entry = LogEntry(LogLevel::WARNING, "GPU temperature threshold approaching");
+            entry.threadId = threadIds[3];
+        } else {
+            entry = LogEntry(LogLevel::ERROR, errors[gen() % 5]);
+            entry.threadId = threadIds[3];
+        }
+        formatter.appendLine(blocks.back(), entry, wallTime);
+        if (blocks.back().size() >= 64 * 1024) {
+            blocks.emplace_back();
+        }
+    }
+    
+    size_t rawBytes = 0;
+    for (const auto& block : blocks) {
+        rawBytes += block.size();
+    }
+    const double megabytes = rawBytes / (1024.0 * 1024.0);
+    
+    LzCompressor compressor;
+    std::vector<std::string> frames(blocks.size());
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < blocks.size(); i++) {
+        appendLzFrame(frames[i], blocks[i].data(), blocks[i].size(), compressor);
+    }
+    double compressSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    size_t frameBytes = 0;
+    for (const auto& frame : frames) {
+        frameBytes += frame.size();
+    }
+    
+    std::string output(64 * 1024 + 1024, '\0');
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < frames.size(); i++) {
+        const std::string& frame = frames[i];
+        lzDecompress(frame.data() + kLzFrameHeaderSize, frame.size() - kLzFrameHeaderSize, &output[0],
+                     blocks[i].size());
+    }
+    double decompressSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+#if DRIVER_LOG_ZLIB
+    // zlib's fastest level over the same blocks, for reference
+    std::vector<Bytef> deflated(compressBound(64 * 1024 + 1024));
+    size_t deflatedBytes = 0;
+    start = std::chrono::steady_clock::now();
+    for (const auto& block : blocks) {
+        uLongf size = deflated.size();
+        compress2(deflated.data(), &size, reinterpret_cast<const Bytef*>(block.data()), block.size(), 1);
+        deflatedBytes += size;
+    }
+    double deflateSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+#endif
+    
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "  Simulator workload: " << megabytes << " MB of text in " << blocks.size() << " blocks" << std::endl;
+    std::cout << "  LZ blocks:   ratio " << std::setprecision(2) << static_cast<double>(rawBytes) / frameBytes
+              << ":1, compress " << std::setprecision(0) << megabytes / compressSeconds << " MB/s, decompress "
+              << megabytes / decompressSeconds << " MB/s" << std::endl;
+#if DRIVER_LOG_ZLIB
+    std::cout << "  zlib -1:     ratio " << std::setprecision(2) << static_cast<double>(rawBytes) / deflatedBytes
+              << ":1, compress " << std::setprecision(0) << megabytes / deflateSeconds << " MB/s" << std::endl;
+#endif
+}
+
+// Binary Format Benchmark
+void runBinaryFormatBenchmark() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Binary Output Benchmark" << std::endl;
+    std::cout << "========================================" << std::endl;
+    
+    // Flush-thread CPU per entry: the synchronous flush runs on this thread,
+    // one default-sized buffer (10k entries) at a time
+    auto threadCpuNs = [] {
+        timespec ts;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+    };
+    
+    const int numMessages = 200000;
+    const std::string path = "bench_binary.log";
+    for (OutputFormat format : {OutputFormat::Text, OutputFormat::Binary}) {
+        std::remove(path.c_str());
+        BufferedLogger::Config config;
+        config.outputFile = path;
+        config.consoleOutput = false;
+        config.asyncFlush = false;
+        config.enableDeduplication = false;
+        config.bufferSize = 10001;  // Flush explicitly, below the auto-flush threshold
+        config.outputFormat = format;
+        
+        int64_t flushNs = 0;
+        size_t bytes;
+        {
+            BufferedLogger logger(config);
+            for (int round = 0; round < numMessages / 10000; round++) {
+                for (int i = 0; i < 10000; i++) {
+                    logger.info("Frame " + std::to_string(i) + " presented on pipe A, latency 16ms");
+                }
+                int64_t start = threadCpuNs();
+                logger.forceFlush();
+                flushNs += threadCpuNs() - start;
+            }
+            bytes = logger.getStats().outputBytes;
+        }
+        
+        std::cout << "  " << std::left << std::setw(8) << (format == OutputFormat::Text ? "Text" : "Binary")
+                  << std::right << std::fixed << std::setprecision(1) << static_cast<double>(flushNs) / numMessages
+                  << " ns/entry flush CPU, " << bytes / 1024 << " KiB" << std::endl;
+        
+        if (format == OutputFormat::Binary) {
+            std::FILE* input = std::fopen(path.c_str(), "rb");
+            std::FILE* output = std::fopen("/dev/null", "wb");
+            auto start = std::chrono::steady_clock::now();
+            decodeBinaryLog(input, output);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::fclose(input);
+            std::fclose(output);
+            std::cout << "  log_decode: " << std::setprecision(0) << numMessages / seconds / 1e6 * 1e3
+                      << "k lines/s" << std::endl;
+        }
+    }
+    std::remove(path.c_str());
+}
+
+// Flight Recorder Overhead Benchmark
+void runFlightRecorderBenchmark() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Flight Recorder Overhead" << std::endl;
+    std::cout << "========================================" << std::endl;
+    
+    const int numMessages = 200000;
+    for (bool recorder : {false, true}) {
+        BufferedLogger::Config config;
+        config.outputFile = "bench_flight.log";
+        config.consoleOutput = false;
+        config.enableDeduplication = false;
+        if (recorder) {
+            config.flightRecorderFile = "bench_flight.ring";
+        }
+        
+        BufferedLogger logger(config);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < numMessages; i++) {
+            logger.info("Frame presented on pipe A, latency 16ms");
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "  " << (recorder ? "With flight recorder" : "Without") << ": " << std::fixed
+                  << std::setprecision(1) << ns / numMessages << " ns/log()" << std::endl;
+    }
+    std::remove("bench_flight.log");
+    std::remove("bench_flight.ring");
+    std::remove("bench_flight.ring.prev");
+}
+
+void runOverflowBenchmark() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Overflow Policies (flush stalled 100ms)" << std::endl;
+    std::cout << "========================================" << std::endl;
+    
+    const int numMessages = 100000;
+    const std::pair<OverflowPolicy, const char*> policies[] = {
+        {OverflowPolicy::Grow, "Grow"},
+        {OverflowPolicy::Block, "Block (1ms)"},
+        {OverflowPolicy::DropNewest, "DropNewest"},
+        {OverflowPolicy::DropOldest, "DropOldest"},
+        {OverflowPolicy::DropBelowLevel, "DropBelowLevel"},
+    };
+    for (const auto& policy : policies) {
+        BufferedLogger::Config config;
+        config.outputFile = "bench_overflow.log";
+        config.consoleOutput = false;
+        config.enableDeduplication = false;
+        config.bufferSize = 1000;
+        config.overflowPolicy = policy.first;
+        config.overflowBlockTimeout = std::chrono::milliseconds(1);
+        
+        BufferedLogger logger(config);
+        logger.setFlushCallback([](const std::vector<LogEntry>&) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        });
+        size_t peakPending = 0;
+        double worstNs = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < numMessages; i++) {
+            auto before = std::chrono::steady_clock::now();
+            logger.info("Frame " + std::to_string(i) + " presented on pipe A");
+            worstNs = std::max(worstNs, std::chrono::duration<double, std::nano>(
+                                            std::chrono::steady_clock::now() - before).count());
+            peakPending = std::max(peakPending, logger.getStats().currentBufferSize.load());
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "  " << std::left << std::setw(16) << policy.second << std::right << std::fixed
+                  << std::setprecision(1) << ns / numMessages << " ns/log(), worst " << worstNs / 1e6
+                  << " ms, peak pending " << peakPending << ", dropped " << logger.getStats().totalDropped
+                  << std::endl;
+    }
+    std::remove("bench_overflow.log");
+}
+
+void runRateLimitBenchmark() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Rate-Limited Call Sites" << std::endl;
+    std::cout << "========================================" << std::endl;
+    
+    BufferedLogger::Config config;
+    config.outputFile = "bench_ratelimit.log";
+    config.consoleOutput = false;
+    config.enableDeduplication = false;
+    BufferedLogger logger(config);
+    
+    const int numMessages = 1000000;
+    for (int threads : {1, 4}) {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back([&logger, threads] {
+                for (int i = 0; i < numMessages / threads; i++) {
+                    DRIVER_LOG_SITE_LIMITED(logger, LogLevel::INFO, 100, 10, "Frame %d took %dms", i, 17);
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "  " << threads << " thread(s), 100/s limit: " << std::fixed << std::setprecision(1)
+                  << ns / numMessages << " ns/call" << std::endl;
+    }
+    std::cout << "  Let through: " << logger.getStats().totalLogged << " of " << 2 * numMessages << std::endl;
+    logger.shutdown();
+    std::remove("bench_ratelimit.log");
+}
+
+void runSinkPipelineBenchmark() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Slow Sink (2ms per batch)" << std::endl;
+    std::cout << "========================================" << std::endl;
+    
+    const int numMessages = 100000;
+    for (bool dedicated : {false, true}) {
+        BufferedLogger::Config config;
+        config.outputFile = "bench_pipeline.log";
+        config.consoleOutput = false;
+        config.enableDeduplication = false;
+        config.bufferSize = 1000;
+        config.asyncFlush = false;  // Every flush on the producer, so its cost shows
+        
+        BufferedLogger logger(config);
+        SinkOptions options;
+        options.dedicatedThread = dedicated;
+        auto slowSink = [](const LogBatch&, const LogEntry* const*, size_t) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        };
+        size_t sink = logger.sinks().add(std::make_unique<CallbackSink>(slowSink), options);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < numMessages; i++) {
+            logger.info("Frame " + std::to_string(i) + " presented on pipe A");
+        }
+        logger.forceFlush();
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        logger.shutdown();  // Lets the sink thread finish its queue
+        std::cout << "  " << (dedicated ? "Own thread" : "Inline    ") << ": " << std::fixed << std::setprecision(1)
+                  << ns / numMessages << " ns/log(), sink got " << logger.sinks().stats(sink).batches
+                  << " batches, dropped " << logger.sinks().stats(sink).droppedBatches << std::endl;
     }
+    std::remove("bench_pipeline.log");
 }
 
 int main() {
@@ -716,11 +3397,47 @@ int main() {
     testDynamicConfiguration(harness);
     testEdgeCases(harness);
     testShutdownCleanup(harness);
+    testPerThreadRings(harness);
+    testMpscQueue(harness);
+    testDeferredFormatting(harness);
+    testLogSiteRegistry(harness);
+    testAllocationFreeLogging(harness);
+    testGenerationArena(harness);
+    testBufferedByteAccounting(harness);
+    testConcurrentDeduplication(harness);
+    testMessageHash(harness);
+    testCompileTimeLevels(harness);
+    testLogCategories(harness);
+    testClockSources(harness);
+    testLineFormatting(harness);
+    testBatchedOutput(harness);
+    testIoUringSink(harness);
+    testDirectSink(harness);
+    testMmapSink(harness);
+    testLogRotation(harness);
+    testBlockCompression(harness);
+    testBinaryFormat(harness);
+    testFlightRecorder(harness);
+    testEmergencyFlush(harness);
+    testOverflowPolicies(harness);
+    testRateLimiting(harness);
+    testSinkPipeline(harness);
     
     harness.printSummary();
     
     // Run performance benchmark
-    runPerformanceBenchmark();
+    runPerformanceBenchmark(harness);
+    runHashBenchmark();
+    runClockBenchmark();
+    runFormatBenchmark();
+    runSinkBenchmark();
+    runRotationBenchmark();
+    runCompressionBenchmark();
+    runBinaryFormatBenchmark();
+    runFlightRecorderBenchmark();
+    runOverflowBenchmark();
+    runRateLimitBenchmark();
+    runSinkPipelineBenchmark();
     
     return 0;
 }
\ No newline at end of file